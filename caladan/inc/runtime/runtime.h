@@ -72,6 +72,17 @@ static inline int runtime_guaranteed_cores(void)
 	return guaranteedks;
 }
 
+/**
+ * runtime_socket - returns the NUMA node of the runtime
+ *
+ * The IOKernel schedules all kthreads of the runtime on this node.
+ */
+static inline int runtime_socket(void)
+{
+	extern int preferred_socket;
+	return preferred_socket;
+}
+
 static inline int runtime_free_mem_mbs(void)
 {
 	return ACCESS_ONCE(runtime_congestion->free_mem_mbs);
@@ -2,9 +2,12 @@
  * ias.c - the Interference-Aware Scheduler (IAS) policy
  */
 
+#include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <float.h>
+#include <unistd.h>
 
 #include <base/stddef.h>
 #include <base/log.h>
@@ -52,6 +55,7 @@ static int ias_attach(struct proc *p, struct sched_spec *sched_cfg)
 {
 	struct ias_data *sd;
 	int i, core, sib;
+	char statm_path[32];
 
 	/* validate parameters */
 	if (ias_procs_nr >= IAS_NPROC)
@@ -105,6 +109,10 @@ static int ias_attach(struct proc *p, struct sched_spec *sched_cfg)
 #endif
 	}
 
+	/* used by the PS subcontroller to track the memory usage trend */
+	snprintf(statm_path, sizeof(statm_path), "/proc/%d/statm", p->pid);
+	sd->statm_fd = open(statm_path, O_RDONLY);
+
 	/* reserve a unique index */
 	for (i = 0; i < ias_procs_nr; i++) {
 		if (ias_procs[i] == NULL) {
@@ -143,6 +151,8 @@ static void ias_detach(struct proc *p)
 			cores[i] = NULL;
 	}
 
+	if (sd->statm_fd >= 0)
+		close(sd->statm_fd);
 	free(sd);
 }
 
@@ -21,6 +21,22 @@
 #define IAS_PS_CPU_THRESH_US            2000
 /* the interval to trigger PS subcontroller */
 #define IAS_PS_INTERVAL_US              500
+/* the interval to sample memory usage trends (RSS and PSI) */
+#define IAS_PS_TREND_INTERVAL_US	10000
+/* the EWMA weight of a new RSS growth rate sample */
+#define IAS_PS_TREND_EWMA_WEIGHT	0.2f
+/* how far ahead (in seconds) the RSS growth is projected */
+#define IAS_PS_TREND_LOOKAHEAD_S	1.0f
+/* the expected migration throughput, used to estimate evacuation time */
+#define IAS_PS_MIGRATION_MBPS		1000.0f
+/* the PSI "some avg10" percentage that indicates memory stalls */
+#define IAS_PS_PSI_SOME_THRESH		5.0f
+/* the max amount of memory evacuated per early (predictive) round */
+#define IAS_PS_EARLY_RELEASE_MB		256
+/* the min interval between two early (predictive) rounds */
+#define IAS_PS_EARLY_INTERVAL_US	100000
+/* an early round that has not reached its target by then is abandoned */
+#define IAS_PS_EARLY_ROUND_TIMEOUT_US	1000000
 /* the interval to trigger RP subcontroller */
 #define IAS_RP_INTERVAL_US              250
 /* the time before the core-local cache is assumed to be evicted */
@@ -32,6 +48,17 @@
  * Data structures
  */
 
+/* per-process memory usage trend, see ias_ps_trend.c */
+struct ias_mem_trend {
+	uint64_t		last_us;
+	int64_t			last_rss_mbs;
+	/* the EWMA of the RSS growth rate, in MB/s */
+	float			growth_mbps;
+	/* evacuate until the RSS drops to this, or 0 if not evacuating */
+	int64_t			release_target_mbs;
+	uint64_t		last_release_us;
+};
+
 struct ias_data {
 	struct proc		*p;
 	unsigned int		is_congested:1;
@@ -66,6 +93,10 @@ struct ias_data {
 	bool                    react_cpu_pressure;
 	/* used for monitoring the duration of cpu pressure */
 	uint64_t                cpu_pressure_start_us;
+	/* used for predicting memory pressure */
+	int			statm_fd;
+	struct ias_mem_trend	mem_trend;
+	int64_t			early_release_mbs;
 };
 
 extern struct list_head all_procs;
@@ -123,6 +154,14 @@ extern float ias_bw_estimate_multiplier;
 
 extern void ias_ps_poll(void);
 
+/* These are pure functions of their inputs so that traces can be replayed. */
+extern void ias_mem_trend_sample(struct ias_mem_trend *t, uint64_t now_us,
+				 int64_t rss_mbs);
+extern int64_t ias_mem_trend_release_mbs(struct ias_mem_trend *t,
+					 uint64_t now_us, int64_t free_ram_mbs,
+					 float node_growth_mbps,
+					 float psi_some_avg10);
+
 /*
  * Resource Reporting (RP) subcontroller definitions
  */
@@ -1,5 +1,8 @@
+#include <fcntl.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/sysinfo.h>
+#include <unistd.h>
 
 #include <base/hash.h>
 #include <base/log.h>
@@ -68,6 +71,81 @@ done:
 	sd->is_lc = is_lc;
 }
 
+/* the time of the last memory usage trend sample */
+static uint64_t ias_ps_trend_last_us;
+/* /proc/pressure/memory, or < 0 if PSI is unavailable */
+static int ias_ps_psi_fd = -1;
+static bool ias_ps_psi_opened;
+
+static float ias_ps_read_psi_some_avg10(void)
+{
+	char buf[256];
+	ssize_t len;
+	float avg10;
+
+	if (unlikely(!ias_ps_psi_opened)) {
+		ias_ps_psi_opened = true;
+		ias_ps_psi_fd = open("/proc/pressure/memory", O_RDONLY);
+		if (ias_ps_psi_fd < 0)
+			log_warn("ias_ps: PSI is unavailable");
+	}
+	if (ias_ps_psi_fd < 0)
+		return 0;
+
+	len = pread(ias_ps_psi_fd, buf, sizeof(buf) - 1, 0);
+	if (len <= 0)
+		return 0;
+	buf[len] = '\0';
+	if (sscanf(buf, "some avg10=%f", &avg10) != 1)
+		return 0;
+	return avg10;
+}
+
+static int64_t ias_ps_read_rss_mbs(struct ias_data *sd)
+{
+	char buf[128];
+	unsigned long size, resident;
+	ssize_t len;
+
+	if (sd->statm_fd < 0)
+		return -1;
+
+	len = pread(sd->statm_fd, buf, sizeof(buf) - 1, 0);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+	if (sscanf(buf, "%lu %lu", &size, &resident) != 2)
+		return -1;
+	return resident * PGSIZE_4KB / SIZE_MB;
+}
+
+/* Samples the memory usage trends and updates the early release amounts. */
+static void ias_ps_trend_poll(int64_t free_ram_mbs)
+{
+	struct ias_data *sd;
+	float node_growth_mbps = 0, psi_some_avg10;
+	int64_t rss_mbs;
+
+	ias_for_each_proc(sd) {
+		if (!sd->react_mem_pressure)
+			continue;
+		rss_mbs = ias_ps_read_rss_mbs(sd);
+		if (rss_mbs < 0)
+			continue;
+		ias_mem_trend_sample(&sd->mem_trend, now_us, rss_mbs);
+		node_growth_mbps += MAX(sd->mem_trend.growth_mbps, 0);
+	}
+
+	psi_some_avg10 = ias_ps_read_psi_some_avg10();
+	ias_for_each_proc(sd) {
+		if (!sd->react_mem_pressure || sd->statm_fd < 0)
+			continue;
+		sd->early_release_mbs = ias_mem_trend_release_mbs(
+			&sd->mem_trend, now_us, free_ram_mbs, node_growth_mbps,
+			psi_some_avg10);
+	}
+}
+
 void ias_ps_poll(void)
 {
 	bool has_pressure;
@@ -86,6 +164,11 @@ void ias_ps_poll(void)
 	else
 		to_release_mem_mbs = 0;
 
+	if (now_us - ias_ps_trend_last_us >= IAS_PS_TREND_INTERVAL_US) {
+		ias_ps_trend_last_us = now_us;
+		ias_ps_trend_poll(free_ram_mbs);
+	}
+
 	ias_for_each_proc(sd) {
 		pressure = sd->p->resource_pressure_info;
 		congestion = sd->p->congestion_info;
@@ -102,8 +185,8 @@ void ias_ps_poll(void)
 		/* Memory pressure. */
 		if (sd->react_mem_pressure) {
 			pressure->to_release_mem_mbs =
-				to_release_mem_mbs;
-			has_pressure = to_release_mem_mbs;
+				MAX(to_release_mem_mbs, sd->early_release_mbs);
+			has_pressure = pressure->to_release_mem_mbs;
 		}
 
 		/* CPU pressure. */
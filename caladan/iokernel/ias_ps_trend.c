@@ -0,0 +1,90 @@
+/*
+ * ias_ps_trend.c - predictive memory pressure detection
+ *
+ * Watermarks only fire once the node is already short of memory, at which
+ * point migration competes with swapping. Instead, the RSS growth rate of
+ * each process is tracked, and a gradual, rate-limited evacuation starts once
+ * the projected time until the watermark is hit drops below the time it takes
+ * to migrate the memory the process is about to allocate. Memory stalls
+ * reported by PSI trigger it as well.
+ *
+ * The functions here do no I/O, so that recorded traces can be replayed.
+ */
+
+#include <base/stddef.h>
+#include <base/time.h>
+
+#include "defs.h"
+#include "ias.h"
+
+/**
+ * ias_mem_trend_sample - records a new RSS sample of a process
+ * @t: the trend of the process
+ * @now_us: the current time
+ * @rss_mbs: the current RSS of the process
+ */
+void ias_mem_trend_sample(struct ias_mem_trend *t, uint64_t now_us,
+			  int64_t rss_mbs)
+{
+	float rate_mbps;
+
+	if (t->last_us && now_us > t->last_us) {
+		rate_mbps = (float)(rss_mbs - t->last_rss_mbs) * ONE_SECOND /
+			    (now_us - t->last_us);
+		t->growth_mbps = IAS_PS_TREND_EWMA_WEIGHT * rate_mbps +
+				 (1 - IAS_PS_TREND_EWMA_WEIGHT) * t->growth_mbps;
+	}
+	t->last_us = now_us;
+	t->last_rss_mbs = rss_mbs;
+}
+
+/**
+ * ias_mem_trend_release_mbs - decides how much memory a process should release
+ * @t: the trend of the process
+ * @now_us: the current time
+ * @free_ram_mbs: the free memory of the node
+ * @node_growth_mbps: the total RSS growth rate of all growing processes
+ * @psi_some_avg10: the PSI "some avg10" memory stall percentage of the node
+ *
+ * Returns the number of MBs to release, or 0 if there is no need.
+ */
+int64_t ias_mem_trend_release_mbs(struct ias_mem_trend *t, uint64_t now_us,
+				  int64_t free_ram_mbs, float node_growth_mbps,
+				  float psi_some_avg10)
+{
+	float lookahead_mbs, migration_us, exhaustion_us;
+	int64_t headroom_mbs, release_mbs;
+
+	/*
+	 * keep evacuating until the ongoing round is done, or gives up because
+	 * the process keeps allocating as fast as it is evacuated
+	 */
+	if (t->release_target_mbs) {
+		if (t->last_rss_mbs > t->release_target_mbs &&
+		    now_us - t->last_release_us < IAS_PS_EARLY_ROUND_TIMEOUT_US)
+			return t->last_rss_mbs - t->release_target_mbs;
+		t->release_target_mbs = 0;
+	}
+
+	if (t->growth_mbps <= 0 ||
+	    now_us - t->last_release_us < IAS_PS_EARLY_INTERVAL_US)
+		return 0;
+
+	lookahead_mbs = t->growth_mbps * IAS_PS_TREND_LOOKAHEAD_S;
+	migration_us = lookahead_mbs / IAS_PS_MIGRATION_MBPS * ONE_SECOND;
+	headroom_mbs = free_ram_mbs - IAS_PS_MEM_LOW_MB;
+	node_growth_mbps = MAX(node_growth_mbps, t->growth_mbps);
+	exhaustion_us = MAX(headroom_mbs, 0) / node_growth_mbps * ONE_SECOND;
+	if (exhaustion_us >= migration_us &&
+	    psi_some_avg10 < IAS_PS_PSI_SOME_THRESH)
+		return 0;
+
+	release_mbs = MIN(MAX((int64_t)lookahead_mbs, 1),
+			  IAS_PS_EARLY_RELEASE_MB);
+	release_mbs = MIN(release_mbs, t->last_rss_mbs - 1);
+	if (release_mbs <= 0)
+		return 0;
+	t->release_target_mbs = t->last_rss_mbs - release_mbs;
+	t->last_release_us = now_us;
+	return release_mbs;
+}
@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <iostream>
 #include <numeric>
+#include <random>
 #include <vector>
 
 extern "C" {
@@ -17,9 +18,26 @@ extern "C" {
 
 constexpr uint32_t kObjSize = 16777216;
 constexpr uint32_t kNumObjs = 1024;
+constexpr bool kCompressibleHeap = false;
 
 class Obj {
 public:
+  Obj() {
+    if constexpr (kCompressibleHeap) {
+      // Mimic a heap full of short text posts.
+      constexpr static const char *kWords[] = {
+          "the ", "migration ", "of ", "a ", "proclet ", "is ", "fast ",
+          "when ", "its ", "heap ", "compresses ", "well ", "#nu ", "@user "};
+      std::mt19937 gen(reinterpret_cast<uintptr_t>(this));
+      std::uniform_int_distribution<uint32_t> dist(0, std::size(kWords) - 1);
+      uint32_t i = 0;
+      while (i < kObjSize) {
+        for (auto *c = kWords[dist(gen)]; *c && i < kObjSize; c++) {
+          bytes[i++] = *c;
+        }
+      }
+    }
+  }
   uint32_t get_ip() { return get_cfg_ip(); }
 private:
   uint8_t bytes[kObjSize];
@@ -7,11 +7,11 @@ LPID=1
 SRC_SRV_IDX=1
 DEST_SRV_IDX=2
 
-pushd $NU_DIR
-sed "s/\(constexpr static bool kEnableLogging =\).*/\1 true;/g" -i src/migrator.cpp
-make -j`nproc`
-popd
+function run_all_heap_sizes {
+compressible=$1
+log_suffix=$2
 
+sed "s/\(constexpr bool kCompressibleHeap =\).*/\1 $compressible;/g" -i main.cpp
 make clean
 
 for heap_size in ${HEAP_SIZES[@]}
@@ -28,15 +28,34 @@ do
     start_ctrl $SRC_SRV_IDX
     sleep 5
 
-    start_server main $SRC_SRV_IDX $LPID 1>logs/$heap_size.src 2>&1 &
+    start_server main $SRC_SRV_IDX $LPID 1>logs/$heap_size$log_suffix.src 2>&1 &
     sleep 5
-    start_main_server main $DEST_SRV_IDX $LPID 1>logs/$heap_size.dest 2>&1
+    start_main_server main $DEST_SRV_IDX $LPID 1>logs/$heap_size$log_suffix.dest 2>&1
 
     cleanup
     sleep 5
 done
+}
+
+pushd $NU_DIR
+sed "s/\(constexpr static bool kEnableLogging =\).*/\1 true;/g" -i src/migrator.cpp
+make -j`nproc`
+popd
+
+run_all_heap_sizes false
+
+# Compressible heap, with and without compressing migration stripes.
+run_all_heap_sizes true .compressible
+
+pushd $NU_DIR
+sed "s/\(constexpr static bool kEnableCompression =\).*/\1 true;/g" -i inc/nu/migrator.hpp
+make -j`nproc`
+popd
+
+run_all_heap_sizes true .compressible.lz4
 
 pushd $NU_DIR
+sed "s/\(constexpr static bool kEnableCompression =\).*/\1 false;/g" -i inc/nu/migrator.hpp
 sed "s/\(constexpr static bool kEnableLogging =\).*/\1 false;/g" -i src/migrator.cpp
 make -j
 popd
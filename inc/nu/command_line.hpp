@@ -32,6 +32,7 @@ struct CaladanOptionsDesc : public OptionsDesc {
   int kthreads;
   int guaranteed;
   int spinning;
+  int socket;
   std::string ip;
   std::string netmask;
   std::string gateway;
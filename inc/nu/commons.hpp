@@ -40,6 +40,11 @@ struct VAddrRange {
   }
 };
 
+struct ProcletLocation {
+  ProcletID id;
+  NodeIP ip;
+} __attribute__((packed));
+
 template <typename T>
 union MethodPtr {
   T ptr;
@@ -71,7 +76,12 @@ constexpr static uint64_t kStackAlignment = 16;
 constexpr static uint64_t kStackRedZoneSize = 128;
 constexpr static uint64_t kStackSize = 64ULL << 10;
 constexpr static uint64_t kPageSize = 4096;
+constexpr static uint64_t kHugePageSize = 2ULL << 20;
 constexpr static ProcletID kNullProcletID = 0;
+// The reference weight that a proclet is created with. Copies of a handle
+// split its weight locally, the proclet is destructed once all weights have
+// been returned.
+constexpr static uint32_t kProcletInitialWeight = 1 << 16;
 constexpr static uint64_t kMinProcletHeapVAddr = 0x300000000000ULL;
 constexpr static uint64_t kMaxProcletHeapVAddr = 0x400000000000ULL;
 constexpr static uint64_t kMinProcletHeapSize = 1ULL << 25;
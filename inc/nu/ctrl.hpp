@@ -6,12 +6,14 @@
 #include <stack>
 #include <map>
 #include <utility>
+#include <vector>
 
 extern "C" {
 #include <runtime/net.h>
 #include <runtime/tcp.h>
 }
 #include <net.h>
+#include <sync.h>
 
 #include "nu/commons.hpp"
 #include "nu/rpc_client_mgr.hpp"
@@ -61,6 +63,10 @@ struct ProcletHeapSegment {
 class Controller {
  public:
   constexpr static bool kEnableBinaryVerification = true;
+  // Push location updates to nodes that have recently resolved proclets, so
+  // that they don't need to hit stale cache entries first.
+  constexpr static bool kEnableLocationPush = true;
+  constexpr static uint64_t kLocationSubscriptionUs = 10 * kOneSecond;
 
   Controller();
   ~Controller();
@@ -70,7 +76,7 @@ class Controller {
                                                              bool isol);
   void destroy_lp(lpid_t lpid, NodeIP requestor_ip);
   std::optional<std::pair<ProcletID, NodeIP>> allocate_proclet(
-      uint64_t capacity, lpid_t lpid, NodeIP ip_hint);
+      uint64_t capacity, lpid_t lpid, NodeIP ip_hint, ProcletID id_hint = 0);
   void destroy_proclet(VAddrRange heap_segment);
   NodeIP resolve_proclet(ProcletID id);
   std::pair<NodeIP, Resource> acquire_migration_dest(lpid_t lpid,
@@ -80,19 +86,31 @@ class Controller {
   bool acquire_node(lpid_t lpid, NodeIP ip);
   void release_node(lpid_t lpid, NodeIP ip);
   void update_location(ProcletID id, NodeIP proclet_srv_ip);
+  void subscribe_locations(NodeIP ip);
+  void push_location_updates();
+  // Waits for the pushes still in flight, which run in their own threads.
+  void wait_for_location_pushes();
   std::vector<std::pair<NodeIP, Resource>> report_free_resource(
       lpid_t lpid, NodeIP ip, Resource free_resource);
 
  private:
   constexpr static auto kNumProcletSegmentBuckets =
       bsr_64(kMaxProcletHeapSize) - bsr_64(kMinProcletHeapSize) + 1;
-  std::stack<ProcletHeapSegment>
+  // Used as stacks, but searchable so that a specific segment can be claimed.
+  std::vector<ProcletHeapSegment>
       free_proclet_heap_segments_[kNumProcletSegmentBuckets];
   std::stack<VAddrRange> free_stack_cluster_segments_;  // One segment per Node.
   std::set<lpid_t> free_lpids_;
   std::map<lpid_t, MD5Val> lpid_to_md5_;
   std::map<lpid_t, LPInfo> lpid_to_info_;
   std::map<ProcletID, NodeIP> proclet_id_to_ip_;
+  std::vector<ProcletLocation> pending_location_updates_;
+  struct LocationSubscriber {
+    uint64_t last_seen_us;
+    bool pushing;  // Whether a push to it is still in flight.
+  };
+  std::map<NodeIP, LocationSubscriber> location_subscribers_;
+  rt::WaitGroup location_pushes_;
   bool done_;
   Mutex mutex_;
 
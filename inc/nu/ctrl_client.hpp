@@ -46,7 +46,7 @@ class ControllerClient {
                                                              MD5Val md5,
                                                              bool isol);
   std::optional<std::pair<ProcletID, NodeIP>> allocate_proclet(
-      uint64_t capacity, NodeIP ip_hint);
+      uint64_t capacity, NodeIP ip_hint, ProcletID id_hint = 0);
   void destroy_proclet(VAddrRange heap_segment);
   NodeIP resolve_proclet(ProcletID id);
   NodeGuard acquire_node();
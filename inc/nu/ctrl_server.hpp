@@ -37,6 +37,7 @@ struct RPCReqAllocateProclet {
   uint64_t capacity;
   lpid_t lpid;
   NodeIP ip_hint;
+  ProcletID id_hint;
 } __attribute__((packed));
 
 struct RPCRespAllocateProclet {
@@ -101,6 +102,12 @@ struct RPCReqReportFreeResource {
   Resource resource;
 } __attribute__((packed));
 
+struct RPCReqPushLocations {
+  RPCReqType rpc_type = kPushLocations;
+  uint32_t num;
+  ProcletLocation locations[0];
+} __attribute__((packed));
+
 struct RPCReqDestroyLP {
   RPCReqType rpc_type = kDestroyLP;
   lpid_t lpid;
@@ -111,6 +118,7 @@ class ControllerServer {
  public:
   constexpr static bool kEnableLogging = false;
   constexpr static uint64_t kPrintIntervalUs = kOneSecond;
+  constexpr static uint64_t kLocationPushIntervalUs = 100;
   constexpr static uint32_t kTCPListenBackLog = 64;
   constexpr static uint32_t kPort = 2828;
 
@@ -131,6 +139,7 @@ class ControllerServer {
   std::atomic<uint64_t> num_report_free_resource_;
   std::atomic<uint64_t> num_destroy_ip_;
   rt::Thread logging_thread_;
+  rt::Thread location_push_thread_;
   rt::Thread tcp_queue_thread_;
   std::vector<std::unique_ptr<rt::TcpConn>> tcp_conns_;
   std::vector<rt::Thread> tcp_conn_threads_;
@@ -140,10 +149,10 @@ class ControllerServer {
   std::unique_ptr<RPCRespRegisterNode> handle_register_node(
       const RPCReqRegisterNode &req);
   std::unique_ptr<RPCRespAllocateProclet> handle_allocate_proclet(
-      const RPCReqAllocateProclet &req);
+      const RPCReqAllocateProclet &req, NodeIP requestor_ip);
   void handle_destroy_proclet(const RPCReqDestroyProclet &req);
   std::unique_ptr<RPCRespResolveProclet> handle_resolve_proclet(
-      const RPCReqResolveProclet &req);
+      const RPCReqResolveProclet &req, NodeIP requestor_ip);
   RPCRespAcquireMigrationDest handle_acquire_migration_dest(
       const RPCReqAcquireMigrationDest &req);
   RPCRespAcquireNode handle_acquire_node(const RPCReqAcquireNode &req);
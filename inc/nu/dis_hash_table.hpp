@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -15,12 +17,41 @@ extern "C" {
 
 namespace nu {
 
+// Streams the chunks of a table scan shard by shard. The next chunk is
+// fetched in the background while the caller processes the current one.
+template <typename T>
+class DistributedHashTableCursor {
+ public:
+  using Chunk = std::vector<T>;
+  // Returns the chunk starting from bucket_idx of the shard and the index of
+  // the bucket following it.
+  using FetchFn = std::function<Future<std::pair<Chunk, uint64_t>>(
+      uint32_t shard_idx, uint64_t bucket_idx)>;
+
+  DistributedHashTableCursor(FetchFn fetch_fn, uint32_t num_shards,
+                             uint64_t num_buckets_per_shard);
+  DistributedHashTableCursor(DistributedHashTableCursor &&) = default;
+  DistributedHashTableCursor &operator=(DistributedHashTableCursor &&) =
+      default;
+  // Returns std::nullopt once the scan is done. Chunks are never empty.
+  std::optional<Chunk> next();
+
+ private:
+  FetchFn fetch_fn_;
+  uint32_t num_shards_;
+  uint64_t num_buckets_per_shard_;
+  uint32_t shard_idx_;
+  Future<std::pair<Chunk, uint64_t>> prefetched_;
+};
+
 template <typename K, typename V, typename Hash = std::hash<K>,
           typename KeyEqual = std::equal_to<K>, uint64_t NumBuckets = 32768>
 class DistributedHashTable {
  public:
   constexpr static uint32_t kDefaultPowerNumShards = 13;
   constexpr static uint64_t kNumBucketsPerShard = NumBuckets;
+  constexpr static uint64_t kDefaultScanChunkSize = 1024;
+  constexpr static uint64_t kShuffleBatchSize = 1024;
 
   using HashTableShard =
       SyncHashMap<NumBuckets, K, V, Hash, std::equal_to<K>,
@@ -62,6 +93,50 @@ class DistributedHashTable {
       void (*reduce_fn)(RetT &, std::pair<const K, V> &, A0s...),
       A1s &&... args);
   std::vector<std::pair<K, V>> get_all_pairs();
+  // Scans the table in chunks of about chunk_size pairs, holding at most two
+  // chunks on the caller at a time. chunk_size must be positive.
+  DistributedHashTableCursor<std::pair<K, V>> get_cursor(
+      uint64_t chunk_size = kDefaultScanChunkSize);
+  // Like above, but map_fn runs on the shard side and only the results it
+  // appends are streamed back.
+  template <typename RetT, typename... A0s, typename... A1s>
+  DistributedHashTableCursor<RetT> get_cursor(
+      uint64_t chunk_size,
+      void (*map_fn)(std::vector<RetT> &, std::pair<const K, V> &, A0s...),
+      A1s &&... args);
+  template <typename F>
+  void for_each_chunk(F &&f, uint64_t chunk_size = kDefaultScanChunkSize);
+  template <typename F, typename RetT, typename... A0s, typename... A1s>
+  void for_each_chunk(
+      F &&f, uint64_t chunk_size,
+      void (*map_fn)(std::vector<RetT> &, std::pair<const K, V> &, A0s...),
+      A1s &&... args);
+  // The following algorithms run in parallel inside all shards, and no pair
+  // flows through the caller.
+  template <typename... A0s, typename... A1s>
+  void transform_values(void (*fn)(std::pair<const K, V> &, A0s...),
+                        A1s &&... args);
+  template <typename... A0s, typename... A1s>
+  uint64_t count_if(bool (*pred)(std::pair<const K, V> &, A0s...),
+                    A1s &&... args);
+  // Returns the k pairs with the highest scores in descending order.
+  template <typename S>
+  std::vector<std::pair<K, V>> top_k(
+      uint32_t k, S (*score_fn)(const std::pair<const K, V> &));
+  // Puts the pairs satisfying pred into dst.
+  template <typename... A0s, typename... A1s>
+  void filter_to(DistributedHashTable &dst,
+                 bool (*pred)(std::pair<const K, V> &, A0s...),
+                 A1s &&... args);
+  // Puts the pairs that map_fn emits for each pair into dst. They are
+  // shuffled straight from the source shards to the destination shards
+  // owning their keys, in batches of kShuffleBatchSize.
+  template <typename K2, typename V2, typename H2, typename E2, uint64_t N2,
+            typename... A0s, typename... A1s>
+  void map_to(DistributedHashTable<K2, V2, H2, E2, N2> &dst,
+              void (*map_fn)(std::vector<std::pair<K2, V2>> &,
+                             std::pair<const K, V> &, A0s...),
+              A1s &&... args);
   template <typename K1>
   static uint32_t get_shard_idx(K1 &&k, uint32_t power_num_shards);
   ProcletID get_shard_proclet_id(uint32_t shard_id);
@@ -85,6 +160,15 @@ class DistributedHashTable {
   std::vector<WeakProclet<HashTableShard>> shards_;
 
   uint32_t get_shard_idx(uint64_t key_hash);
+  template <typename K2, typename V2, typename H2, typename E2, uint64_t N2,
+            typename... A0s>
+  static void shuffle_to(HashTableShard &shard,
+                         DistributedHashTable<K2, V2, H2, E2, N2> dst,
+                         void (*map_fn)(std::vector<std::pair<K2, V2>> &,
+                                        std::pair<const K, V> &, A0s...),
+                         A0s... args);
+  template <typename X, typename Y, typename H, typename Eq, uint64_t N>
+  friend class DistributedHashTable;
   template <typename X, typename Y, typename H, typename Eq, uint64_t N>
   friend DistributedHashTable<X, Y, H, Eq, N> make_dis_hash_table(
       uint32_t power_num_shards, bool pinned);
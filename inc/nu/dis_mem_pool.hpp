@@ -3,6 +3,7 @@
 #include <deque>
 #include <memory>
 #include <optional>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,15 @@ class DistributedMemPool {
  public:
   constexpr static uint32_t kFullShardProbingIntervalMs = 400;
   constexpr static uint32_t kShardSize = 2 << 20;
+  // Upper bound of the objects allocated by a single call into a shard, whose
+  // reply is itself built on the shard's heap.
+  constexpr static uint32_t kMaxNumAllocationsPerCall = 4096;
+  // Default-constructed trivial objects of up to kMaxReservedSlotSize bytes are
+  // handed out from per-core ranges of slots reserved kNumSlotsPerReservation
+  // at a time, so that allocating them does not involve a remote call.
+  constexpr static uint32_t kMaxReservedSlotSize = 64;
+  constexpr static uint32_t kNumSlotsPerReservation = 256;
+  constexpr static uint32_t kReservedSlotGranularity = 8;
 
   DistributedMemPool();
   DistributedMemPool(const DistributedMemPool &) = delete;
@@ -52,6 +62,12 @@ class DistributedMemPool {
   void free_raw(const RemRawPtr<T> &ptr);
   template <typename T>
   Future<void> free_raw_async(const RemRawPtr<T> &ptr);
+  // Allocates count objects constructed from args with one call per shard.
+  template <typename T, typename... As>
+  std::vector<RemRawPtr<T>> allocate_raw_n(uint32_t count, As &&... args);
+  // Frees ptrs with one call per shard.
+  template <typename T>
+  void free_raw_n(const std::vector<RemRawPtr<T>> &ptrs);
 
   template <class Archive>
   void save_move(Archive &ar);
@@ -67,8 +83,14 @@ class DistributedMemPool {
     RemUniquePtr<T> allocate_unique(As... args);
     template <typename T, typename... As>
     RemSharedPtr<T> allocate_shared(As... args);
+    template <typename T, typename... As>
+    std::vector<RemRawPtr<T>> allocate_raw_n(uint32_t count, As... args);
+    std::vector<RemRawPtr<uint8_t>> reserve_slots(uint32_t slot_size,
+                                                  uint32_t count);
     template <typename T>
     void free_raw(T *raw_ptr);
+    template <typename T>
+    void free_raw_n(std::vector<T *> raw_ptrs);
     bool has_space_for(uint32_t size);
   };
 
@@ -106,7 +128,34 @@ class DistributedMemPool {
     }
   };
 
+  constexpr static uint32_t kNumReservedSlotClasses =
+      kMaxReservedSlotSize / kReservedSlotGranularity;
+
+  struct alignas(kCacheLineBytes) ReservedSlotsPerCoreCache {
+    std::vector<RemRawPtr<uint8_t>> slots[kNumReservedSlotClasses];
+
+    template <class Archive>
+    void save_move(Archive &ar) {
+      for (auto &s : slots) {
+        ar(std::move(s));
+      }
+    }
+
+    template <class Archive>
+    void load(Archive &ar) {
+      for (auto &s : slots) {
+        ar(s);
+      }
+    }
+  };
+
+  template <typename T>
+  constexpr static bool kReservable =
+      std::is_trivial_v<T> && sizeof(T) <= kMaxReservedSlotSize &&
+      alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
   FreeShardPerCoreCache local_free_shards_[kNumCores];
+  ReservedSlotsPerCoreCache reserved_slots_[kNumCores];
   std::deque<Shard> global_free_shards_;
   std::deque<Shard> global_full_shards_;
   Mutex global_mutex_;
@@ -121,6 +170,10 @@ class DistributedMemPool {
 
   template <typename T, typename AllocFn, typename... As>
   auto __allocate(AllocFn &&alloc_fn, As &&... args);
+  template <typename T>
+  RemRawPtr<T> allocate_reserved();
+  template <typename RetT>
+  static bool alloc_failed(const RetT &ret);
   void __handle_local_free_shard_full();
   void __handle_no_local_free_shard();
   void check_probing();
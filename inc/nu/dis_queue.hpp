@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "nu/container.hpp"
+#include "nu/proclet.hpp"
+#include "nu/utils/cond_var.hpp"
+#include "nu/utils/mutex.hpp"
+
+namespace nu {
+
+template <typename T>
+class QueueImpl {
+ public:
+  using Key = std::size_t;
+  using Val = T;
+
+  std::size_t size() const;
+  bool empty() const;
+  void clear();
+  std::size_t push_back(Val v);
+  void push_back_batch(std::vector<Val> vs);
+  std::vector<Val> try_pop_front(std::size_t num);
+
+  template <class Archive>
+  void serialize(Archive &ar);
+
+ private:
+  std::deque<T> deque_;
+};
+
+template <typename T>
+class QueueShard {
+ public:
+  QueueShard();
+  std::size_t size();
+  void push_back_batch(std::vector<T> vs);
+  // Pops up to num elements, also returning the wake-up sequence number that
+  // pop_front() waits on.
+  std::pair<std::vector<T>, uint64_t> try_pop_front(std::size_t num);
+  // Pops up to num elements. If there are none, wakes up the consumers blocked
+  // in the hungry shard once new elements arrive.
+  std::vector<T> try_steal(std::size_t num, WeakProclet<QueueShard> hungry);
+  // Blocks until there are elements or the wake-up sequence number moves past
+  // wake_seq. Returns no element in the latter case.
+  std::vector<T> pop_front(std::size_t num, uint64_t wake_seq);
+  void wake_up();
+
+ private:
+  GeneralContainer<QueueImpl<T>> container_;
+  Mutex mutex_;
+  CondVar cv_;
+  uint32_t num_waiters_;
+  uint64_t wake_seq_;
+  std::vector<WeakProclet<QueueShard>> hungry_shards_;
+};
+
+// A multi-producer multi-consumer queue made of several shard proclets.
+// Producers buffer elements and push them in batches to the shards in a
+// round-robin manner, flushing once the batch is full or its oldest element
+// has waited for flush_timeout_us. Consumers pull batches from their home
+// shard, steal from the others once it runs dry, and block in their home shard
+// once the whole queue is empty. Each thread should use its own copy of the
+// handle. The queue is not FIFO across shards.
+template <typename T>
+class DistributedQueue {
+ public:
+  constexpr static uint32_t kDefaultNumShards = 8;
+  constexpr static uint32_t kDefaultMaxBatchSize = 64;
+  constexpr static uint64_t kDefaultFlushTimeoutUs = 50;
+
+  DistributedQueue();
+  DistributedQueue(const DistributedQueue &);
+  DistributedQueue &operator=(const DistributedQueue &);
+  DistributedQueue(DistributedQueue &&);
+  DistributedQueue &operator=(DistributedQueue &&);
+  ~DistributedQueue();
+  void push(T v);
+  void flush();
+  // Pops up to num elements, blocking while the queue is empty. Returns right
+  // away if num is 0.
+  std::vector<T> pop(std::size_t num);
+  // Pops up to num elements without blocking.
+  std::vector<T> try_pop(std::size_t num);
+  std::size_t size();
+
+  template <class Archive>
+  void save(Archive &ar) const;
+  template <class Archive>
+  void load(Archive &ar);
+
+ private:
+  using Shard = QueueShard<T>;
+
+  struct RefCnter {
+    std::vector<Proclet<Shard>> shards;
+  };
+
+  Proclet<RefCnter> ref_cnter_;
+  std::vector<WeakProclet<Shard>> shards_;
+  uint32_t max_batch_size_;
+  uint64_t flush_timeout_us_;
+  uint32_t home_idx_;
+  uint32_t next_push_idx_;
+  std::vector<T> push_reqs_;
+  uint64_t oldest_push_us_;
+
+  void pick_home();
+  std::vector<T> try_steal(std::size_t num);
+
+  template <typename U>
+  friend DistributedQueue<U> make_dis_queue(uint32_t, uint32_t, uint64_t,
+                                            bool);
+};
+
+template <typename T>
+DistributedQueue<T> make_dis_queue(
+    uint32_t num_shards = DistributedQueue<T>::kDefaultNumShards,
+    uint32_t max_batch_size = DistributedQueue<T>::kDefaultMaxBatchSize,
+    uint64_t flush_timeout_us = DistributedQueue<T>::kDefaultFlushTimeoutUs,
+    bool pinned = false);
+
+}  // namespace nu
+
+#include "nu/impl/dis_queue.ipp"
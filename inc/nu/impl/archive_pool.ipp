@@ -57,6 +57,7 @@ inline void ArchivePool<Allocator>::put_oa_sstream(OASStream *oa_sstream) {
     oa_sstream->ss.str(String(kOAStreamPreallocBufSize, '\0'));
   }
   oa_sstream->ss.seekp(0);
+  oa_sstream->bulk_segs.clear();
   return oa_pool_.put(oa_sstream);
 }
 
@@ -1,7 +1,41 @@
+#include <algorithm>
+#include <iterator>
+
 #include "nu/commons.hpp"
 
 namespace nu {
 
+template <typename T>
+inline DistributedHashTableCursor<T>::DistributedHashTableCursor(
+    FetchFn fetch_fn, uint32_t num_shards, uint64_t num_buckets_per_shard)
+    : fetch_fn_(std::move(fetch_fn)),
+      num_shards_(num_shards),
+      num_buckets_per_shard_(num_buckets_per_shard),
+      shard_idx_(0) {
+  if (num_shards_) {
+    prefetched_ = fetch_fn_(shard_idx_, 0);
+  }
+}
+
+template <typename T>
+inline std::optional<typename DistributedHashTableCursor<T>::Chunk>
+DistributedHashTableCursor<T>::next() {
+  while (prefetched_) {
+    auto [chunk, next_bucket_idx] = std::move(prefetched_.get());
+    if (next_bucket_idx < num_buckets_per_shard_) {
+      prefetched_ = fetch_fn_(shard_idx_, next_bucket_idx);
+    } else if (++shard_idx_ < num_shards_) {
+      prefetched_ = fetch_fn_(shard_idx_, 0);
+    } else {
+      prefetched_ = Future<std::pair<Chunk, uint64_t>>();
+    }
+    if (!chunk.empty()) {
+      return std::move(chunk);
+    }
+  }
+  return std::nullopt;
+}
+
 template <typename K, typename V, typename Hash, typename KeyEqual,
           uint64_t NumBuckets>
 inline DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::
@@ -215,6 +249,71 @@ DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::get_all_pairs() {
   return vec;
 }
 
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+inline DistributedHashTableCursor<std::pair<K, V>>
+DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::get_cursor(
+    uint64_t chunk_size) {
+  return get_cursor(
+      chunk_size,
+      +[](std::vector<std::pair<K, V>> &chunk, std::pair<const K, V> &pair) {
+        chunk.emplace_back(pair);
+      });
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename RetT, typename... A0s, typename... A1s>
+DistributedHashTableCursor<RetT>
+DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::get_cursor(
+    uint64_t chunk_size,
+    void (*map_fn)(std::vector<RetT> &, std::pair<const K, V> &, A0s...),
+    A1s &&... args) {
+  // A zero-sized chunk would never move the cursor past any bucket.
+  BUG_ON(!chunk_size);
+  // Holds a copy of the table so that the shards outlive the cursor.
+  auto fetch_fn = [table = *this, chunk_size, map_fn,
+                   ... args = std::forward<A1s>(args)](
+                      uint32_t shard_idx, uint64_t bucket_idx) mutable {
+    return table.shards_[shard_idx].__run_async(
+        +[](HashTableShard &shard, uint64_t bucket_idx, uint64_t chunk_size,
+            decltype(map_fn) map_fn, A0s... args) {
+          auto chunk = shard.associative_reduce_range(
+              &bucket_idx, chunk_size, std::vector<RetT>(), map_fn, args...);
+          return std::make_pair(std::move(chunk), bucket_idx);
+        },
+        bucket_idx, chunk_size, map_fn, args...);
+  };
+  return DistributedHashTableCursor<RetT>(std::move(fetch_fn), num_shards_,
+                                          kNumBucketsPerShard);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename F>
+inline void
+DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::for_each_chunk(
+    F &&f, uint64_t chunk_size) {
+  auto cursor = get_cursor(chunk_size);
+  while (auto chunk = cursor.next()) {
+    f(*chunk);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename F, typename RetT, typename... A0s, typename... A1s>
+inline void
+DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::for_each_chunk(
+    F &&f, uint64_t chunk_size,
+    void (*map_fn)(std::vector<RetT> &, std::pair<const K, V> &, A0s...),
+    A1s &&... args) {
+  auto cursor = get_cursor(chunk_size, map_fn, std::forward<A1s>(args)...);
+  while (auto chunk = cursor.next()) {
+    f(*chunk);
+  }
+}
+
 template <typename K, typename V, typename Hash, typename KeyEqual,
           uint64_t NumBuckets>
 template <typename RetT, typename... A0s, typename... A1s>
@@ -264,6 +363,196 @@ DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::associative_reduce(
   return all_reduced_vals;
 }
 
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename... A0s, typename... A1s>
+void DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::transform_values(
+    void (*fn)(std::pair<const K, V> &, A0s...), A1s &&... args) {
+  std::vector<Future<void>> futures;
+  for (uint32_t i = 0; i < num_shards_; i++) {
+    futures.emplace_back(shards_[i].__run_async(
+        +[](HashTableShard &shard, decltype(fn) fn, A0s... args) {
+          shard.associative_reduce(
+              /* clear = */ false, ErasedType(),
+              +[](ErasedType &, std::pair<const K, V> &pair, decltype(fn) fn,
+                  A0s... args) { fn(pair, args...); },
+              fn, args...);
+        },
+        fn, args...));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename... A0s, typename... A1s>
+uint64_t DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::count_if(
+    bool (*pred)(std::pair<const K, V> &, A0s...), A1s &&... args) {
+  std::vector<Future<uint64_t>> futures;
+  for (uint32_t i = 0; i < num_shards_; i++) {
+    futures.emplace_back(shards_[i].__run_async(
+        +[](HashTableShard &shard, decltype(pred) pred, A0s... args) {
+          return shard.associative_reduce(
+              /* clear = */ false, static_cast<uint64_t>(0),
+              +[](uint64_t &cnt, std::pair<const K, V> &pair,
+                  decltype(pred) pred, A0s... args) {
+                cnt += pred(pair, args...);
+              },
+              pred, args...);
+        },
+        pred, args...));
+  }
+  uint64_t cnt = 0;
+  for (auto &future : futures) {
+    cnt += future.get();
+  }
+  return cnt;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename S>
+std::vector<std::pair<K, V>>
+DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::top_k(
+    uint32_t k, S (*score_fn)(const std::pair<const K, V> &)) {
+  using Scored = std::pair<S, std::pair<K, V>>;
+  using Higher = decltype([](const Scored &x, const Scored &y) {
+    return x.first > y.first;
+  });
+
+  std::vector<Future<std::vector<Scored>>> futures;
+  for (uint32_t i = 0; i < num_shards_; i++) {
+    futures.emplace_back(shards_[i].__run_async(
+        +[](HashTableShard &shard, uint32_t k, decltype(score_fn) score_fn) {
+          // A min-heap of the k highest-scored pairs seen so far.
+          return shard.associative_reduce(
+              /* clear = */ false, std::vector<Scored>(),
+              +[](std::vector<Scored> &heap, std::pair<const K, V> &pair,
+                  uint32_t k, decltype(score_fn) score_fn) {
+                auto score = score_fn(pair);
+                if (heap.size() == k) {
+                  if (!k || !(score > heap.front().first)) {
+                    return;
+                  }
+                  std::pop_heap(heap.begin(), heap.end(), Higher());
+                  heap.back() = Scored(std::move(score), pair);
+                } else {
+                  heap.emplace_back(std::move(score), pair);
+                }
+                std::push_heap(heap.begin(), heap.end(), Higher());
+              },
+              k, score_fn);
+        },
+        k, score_fn));
+  }
+
+  std::vector<Scored> candidates;
+  for (auto &future : futures) {
+    auto &shard_top_k = future.get();
+    candidates.insert(candidates.end(),
+                      std::make_move_iterator(shard_top_k.begin()),
+                      std::make_move_iterator(shard_top_k.end()));
+  }
+  auto num = std::min(static_cast<std::size_t>(k), candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + num,
+                    candidates.end(), Higher());
+  std::vector<std::pair<K, V>> top;
+  top.reserve(num);
+  for (std::size_t i = 0; i < num; i++) {
+    top.emplace_back(std::move(candidates[i].second));
+  }
+  return top;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename... A0s, typename... A1s>
+void DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::filter_to(
+    DistributedHashTable &dst, bool (*pred)(std::pair<const K, V> &, A0s...),
+    A1s &&... args) {
+  map_to(
+      dst,
+      +[](std::vector<std::pair<K, V>> &outputs, std::pair<const K, V> &pair,
+          decltype(pred) pred, A0s... args) {
+        if (pred(pair, args...)) {
+          outputs.emplace_back(pair);
+        }
+      },
+      pred, std::forward<A1s>(args)...);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename K2, typename V2, typename H2, typename E2, uint64_t N2,
+          typename... A0s, typename... A1s>
+void DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::map_to(
+    DistributedHashTable<K2, V2, H2, E2, N2> &dst,
+    void (*map_fn)(std::vector<std::pair<K2, V2>> &, std::pair<const K, V> &,
+                   A0s...),
+    A1s &&... args) {
+  std::vector<Future<void>> futures;
+  for (uint32_t i = 0; i < num_shards_; i++) {
+    futures.emplace_back(shards_[i].__run_async(
+        &DistributedHashTable::template shuffle_to<K2, V2, H2, E2, N2, A0s...>,
+        dst, map_fn, args...));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          uint64_t NumBuckets>
+template <typename K2, typename V2, typename H2, typename E2, uint64_t N2,
+          typename... A0s>
+void DistributedHashTable<K, V, Hash, KeyEqual, NumBuckets>::shuffle_to(
+    HashTableShard &shard, DistributedHashTable<K2, V2, H2, E2, N2> dst,
+    void (*map_fn)(std::vector<std::pair<K2, V2>> &, std::pair<const K, V> &,
+                   A0s...),
+    A0s... args) {
+  using DstShard = DistributedHashTable<K2, V2, H2, E2, N2>::HashTableShard;
+  std::vector<std::vector<std::pair<K2, V2>>> batches(dst.num_shards_);
+  std::vector<Future<void>> futures;
+
+  auto send = [&](uint32_t shard_idx) {
+    futures.emplace_back(dst.shards_[shard_idx].__run_async(
+        +[](DstShard &shard, std::vector<std::pair<K2, V2>> pairs) {
+          for (auto &[k, v] : pairs) {
+            shard.put(std::move(k), std::move(v));
+          }
+        },
+        std::move(batches[shard_idx])));
+    batches[shard_idx].clear();
+  };
+
+  // Maps a range of buckets at a time, so that no bucket lock is held while
+  // sending the batches.
+  uint64_t bucket_idx = 0;
+  while (bucket_idx < kNumBucketsPerShard) {
+    auto outputs = shard.associative_reduce_range(
+        &bucket_idx, kShuffleBatchSize, std::vector<std::pair<K2, V2>>(),
+        map_fn, args...);
+    for (auto &output : outputs) {
+      auto shard_idx = dst.get_shard_idx(H2()(output.first));
+      auto &batch = batches[shard_idx];
+      batch.emplace_back(std::move(output));
+      if (batch.size() >= kShuffleBatchSize) {
+        send(shard_idx);
+      }
+    }
+  }
+  for (uint32_t i = 0; i < batches.size(); i++) {
+    if (!batches[i].empty()) {
+      send(i);
+    }
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
 template <typename K, typename V, typename Hash, typename KeyEqual,
           uint64_t NumBuckets>
 template <class Archive>
@@ -1,3 +1,9 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <unordered_map>
+
 #include "nu/rem_raw_ptr.hpp"
 #include "nu/rem_shared_ptr.hpp"
 #include "nu/rem_unique_ptr.hpp"
@@ -8,6 +14,7 @@ namespace nu {
 
 template <typename T, typename... As>
 inline RemRawPtr<T> DistributedMemPool::Heap::allocate_raw(As... args) {
+  bump_rem_ptr_version();
   return RemRawPtr(new T(std::move(args)...));
 }
 
@@ -21,18 +28,60 @@ inline RemSharedPtr<T> DistributedMemPool::Heap::allocate_shared(As... args) {
   return make_rem_shared<T>(std::move(args)...);
 }
 
+template <typename T, typename... As>
+inline std::vector<RemRawPtr<T>> DistributedMemPool::Heap::allocate_raw_n(
+    uint32_t count, As... args) {
+  bump_rem_ptr_version();
+  std::vector<RemRawPtr<T>> ptrs;
+  ptrs.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    auto *raw_ptr = new T(args...);
+    if (unlikely(!raw_ptr)) {
+      break;
+    }
+    ptrs.emplace_back(raw_ptr);
+  }
+  return ptrs;
+}
+
+inline std::vector<RemRawPtr<uint8_t>> DistributedMemPool::Heap::reserve_slots(
+    uint32_t slot_size, uint32_t count) {
+  bump_rem_ptr_version();
+  std::vector<RemRawPtr<uint8_t>> slots;
+  slots.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    auto *slot =
+        static_cast<uint8_t *>(::operator new(slot_size, std::nothrow));
+    if (unlikely(!slot)) {
+      break;
+    }
+    // Matches the value-initialization done by allocate_raw().
+    memset(slot, 0, slot_size);
+    slots.emplace_back(slot);
+  }
+  return slots;
+}
+
 template <typename T>
 inline void DistributedMemPool::Heap::free_raw(T *raw_ptr) {
+  // The address may be handed out again, so cached reads of it must refetch.
+  bump_rem_ptr_version();
   delete raw_ptr;
 }
 
-inline bool DistributedMemPool::Heap::has_space_for(uint32_t size) {
-  auto buf = new uint8_t[size];
-  if (!buf) {
-    return false;
+template <typename T>
+inline void DistributedMemPool::Heap::free_raw_n(std::vector<T *> raw_ptrs) {
+  bump_rem_ptr_version();
+  for (auto *raw_ptr : raw_ptrs) {
+    delete raw_ptr;
   }
-  delete[] buf;
-  return true;
+}
+
+inline bool DistributedMemPool::Heap::has_space_for(uint32_t size) {
+  // Memory freed back into the slab sits on per-size-class free lists, which
+  // may not serve an allocation of this size, so only count the tail.
+  auto *slab = get_runtime()->get_current_proclet_slab();
+  return slab->get_remaining() >= size;
 }
 
 inline DistributedMemPool::Shard::Shard() {}
@@ -65,6 +114,9 @@ inline DistributedMemPool &DistributedMemPool::operator=(
     local_free_shards_[i] = std::move(o.local_free_shards_[i]);
   }
   global_free_shards_ = std::move(o.global_free_shards_);
+  for (uint32_t i = 0; i < kNumCores; i++) {
+    reserved_slots_[i] = std::move(o.reserved_slots_[i]);
+  }
   global_full_shards_ = std::move(o.global_full_shards_);
   last_probing_us_ = o.last_probing_us_;
   return *this;
@@ -84,8 +136,37 @@ inline void DistributedMemPool::halt_probing() {
 
 template <typename T, typename... As>
 inline RemRawPtr<T> DistributedMemPool::allocate_raw(As &&... args) {
-  return __allocate<T>(&Heap::allocate_raw<T, std::decay_t<As>...>,
-                       std::forward<As>(args)...);
+  if constexpr (sizeof...(As) == 0 && kReservable<T>) {
+    return allocate_reserved<T>();
+  } else {
+    return __allocate<T>(&Heap::allocate_raw<T, std::decay_t<As>...>,
+                         std::forward<As>(args)...);
+  }
+}
+
+template <typename T>
+inline RemRawPtr<T> DistributedMemPool::allocate_reserved() {
+  constexpr auto kSlotClass = (sizeof(T) - 1) / kReservedSlotGranularity;
+  constexpr uint32_t kSlotSize = (kSlotClass + 1) * kReservedSlotGranularity;
+
+  while (true) {
+    auto *slots = &reserved_slots_[get_cpu()].slots[kSlotClass];
+    if (likely(!slots->empty())) {
+      auto slot = std::move(slots->back());
+      slots->pop_back();
+      put_cpu();
+      return RemRawPtr<T>(std::move(slot.proclet_),
+                          reinterpret_cast<T *>(slot.raw_ptr_));
+    }
+    put_cpu();
+
+    auto new_slots =
+        __allocate<T>(&Heap::reserve_slots, kSlotSize, kNumSlotsPerReservation);
+    slots = &reserved_slots_[get_cpu()].slots[kSlotClass];
+    slots->insert(slots->end(), std::make_move_iterator(new_slots.begin()),
+                  std::make_move_iterator(new_slots.end()));
+    put_cpu();
+  }
 }
 
 template <typename T, typename... As>
@@ -98,6 +179,7 @@ inline Future<RemRawPtr<T>> DistributedMemPool::allocate_raw_async(
 
 template <typename T>
 inline void DistributedMemPool::free_raw(const RemRawPtr<T> &ptr) {
+  const_cast<RemRawPtr<T> &>(ptr).invalidate_cached();
   auto &proclet = const_cast<WeakProclet<ErasedType> &>(ptr.proclet_);
   proclet.__run(
       +[](ErasedType &raw_obj, T *raw_ptr) {
@@ -113,6 +195,56 @@ inline Future<void> DistributedMemPool::free_raw_async(
   return nu::async([&] { free_raw(ptr); });
 }
 
+template <typename T, typename... As>
+inline std::vector<RemRawPtr<T>> DistributedMemPool::allocate_raw_n(
+    uint32_t count, As &&... args) {
+  std::vector<RemRawPtr<T>> ptrs;
+  ptrs.reserve(count);
+  while (ptrs.size() < count) {
+    uint32_t batch_size =
+        std::min(count - static_cast<uint32_t>(ptrs.size()),
+                 kMaxNumAllocationsPerCall);
+    // A short batch means that the shard has filled up, which the next call
+    // into it will detect.
+    auto batch = __allocate<T>(
+        &Heap::allocate_raw_n<T, std::decay_t<As>...>, batch_size, args...);
+    ptrs.insert(ptrs.end(), std::make_move_iterator(batch.begin()),
+                std::make_move_iterator(batch.end()));
+  }
+  return ptrs;
+}
+
+template <typename T>
+inline void DistributedMemPool::free_raw_n(
+    const std::vector<RemRawPtr<T>> &ptrs) {
+  std::unordered_map<ProcletID,
+                     std::pair<WeakProclet<ErasedType>, std::vector<T *>>>
+      per_shard_ptrs;
+  for (auto &ptr : ptrs) {
+    const_cast<RemRawPtr<T> &>(ptr).invalidate_cached();
+    auto &[proclet, raw_ptrs] = per_shard_ptrs[ptr.proclet_.get_id()];
+    if (raw_ptrs.empty()) {
+      proclet = ptr.proclet_;
+    }
+    raw_ptrs.push_back(ptr.raw_ptr_);
+  }
+
+  std::vector<Future<void>> futures;
+  futures.reserve(per_shard_ptrs.size());
+  for (auto &[_, shard_ptrs] : per_shard_ptrs) {
+    auto &[proclet, raw_ptrs] = shard_ptrs;
+    futures.emplace_back(proclet.__run_async(
+        +[](ErasedType &raw_obj, std::vector<T *> raw_ptrs) {
+          reinterpret_cast<Heap &>(raw_obj).free_raw_n(std::move(raw_ptrs));
+        },
+        std::move(raw_ptrs)));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+  check_probing();
+}
+
 inline void DistributedMemPool::check_probing() {
   auto cur_us = microtime();
   if (unlikely(cur_us >
@@ -127,6 +259,9 @@ void DistributedMemPool::save_move(Archive &ar) {
   for (auto &local_free_shard : local_free_shards_) {
     ar(std::move(local_free_shard));
   }
+  for (auto &reserved_slots : reserved_slots_) {
+    ar(std::move(reserved_slots));
+  }
   ar(std::move(global_free_shards_), std::move(global_full_shards_));
 }
 
@@ -135,6 +270,9 @@ void DistributedMemPool::load(Archive &ar) {
   for (auto &local_free_shard : local_free_shards_) {
     ar(local_free_shard);
   }
+  for (auto &reserved_slots : reserved_slots_) {
+    ar(reserved_slots);
+  }
   ar(global_free_shards_, global_full_shards_);
   last_probing_us_ = microtime();
   probing_active_ = false;
@@ -169,6 +307,15 @@ inline Future<RemSharedPtr<T>> DistributedMemPool::allocate_shared_async(
   });
 }
 
+template <typename RetT>
+inline bool DistributedMemPool::alloc_failed(const RetT &ret) {
+  if constexpr (requires { ret.empty(); }) {
+    return ret.empty();
+  } else {
+    return !ret;
+  }
+}
+
 template <typename T, typename AllocFn, typename... As>
 auto DistributedMemPool::__allocate(AllocFn &&alloc_fn, As &&... args) {
 retry:
@@ -189,7 +336,7 @@ retry:
     // Try to allocate.
     auto ptr = free_shard.proclet.__run(alloc_fn, std::forward<As>(args)...);
     // The shard turns out to be full, add a mark.
-    if (unlikely(!ptr)) {
+    if (unlikely(alloc_failed(ptr))) {
       // For the performance consideration, here we intentionally allow race
       // conditions which may cause the free shard to be marked as full. It's
       // fine since the mis-classification will soon be rectified by the probing
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <iterator>
+
+extern "C" {
+#include <base/time.h>
+}
+
+#include "nu/utils/scoped_lock.hpp"
+
+namespace nu {
+
+template <typename T>
+inline std::size_t QueueImpl<T>::size() const {
+  return deque_.size();
+}
+
+template <typename T>
+inline bool QueueImpl<T>::empty() const {
+  return deque_.empty();
+}
+
+template <typename T>
+inline void QueueImpl<T>::clear() {
+  deque_.clear();
+}
+
+template <typename T>
+inline std::size_t QueueImpl<T>::push_back(Val v) {
+  deque_.emplace_back(std::move(v));
+  return deque_.size();
+}
+
+template <typename T>
+inline void QueueImpl<T>::push_back_batch(std::vector<Val> vs) {
+  deque_.insert(deque_.end(), std::make_move_iterator(vs.begin()),
+                std::make_move_iterator(vs.end()));
+}
+
+template <typename T>
+inline std::vector<T> QueueImpl<T>::try_pop_front(std::size_t num) {
+  num = std::min(num, deque_.size());
+  std::vector<T> vs(std::make_move_iterator(deque_.begin()),
+                    std::make_move_iterator(deque_.begin() + num));
+  deque_.erase(deque_.begin(), deque_.begin() + num);
+  return vs;
+}
+
+template <typename T>
+template <class Archive>
+inline void QueueImpl<T>::serialize(Archive &ar) {
+  ar(deque_);
+}
+
+template <typename T>
+inline QueueShard<T>::QueueShard() : num_waiters_(0), wake_seq_(0) {}
+
+template <typename T>
+inline std::size_t QueueShard<T>::size() {
+  ScopedLock lock(&mutex_);
+  return container_.size();
+}
+
+template <typename T>
+inline void QueueShard<T>::push_back_batch(std::vector<T> vs) {
+  std::vector<WeakProclet<QueueShard>> hungry_shards;
+  {
+    ScopedLock lock(&mutex_);
+    container_.unwrap().push_back_batch(std::move(vs));
+    if (num_waiters_) {
+      cv_.signal_all();
+    }
+    hungry_shards = std::move(hungry_shards_);
+    hungry_shards_.clear();
+  }
+
+  for (auto &hungry : hungry_shards) {
+    hungry.run(&QueueShard::wake_up);
+  }
+}
+
+template <typename T>
+inline std::pair<std::vector<T>, uint64_t> QueueShard<T>::try_pop_front(
+    std::size_t num) {
+  ScopedLock lock(&mutex_);
+  return std::make_pair(container_.try_pop_front(num), wake_seq_);
+}
+
+template <typename T>
+inline std::vector<T> QueueShard<T>::try_steal(std::size_t num,
+                                               WeakProclet<QueueShard> hungry) {
+  ScopedLock lock(&mutex_);
+  auto vs = container_.try_pop_front(num);
+  if (vs.empty() &&
+      std::none_of(hungry_shards_.begin(), hungry_shards_.end(),
+                   [&](auto &shard) { return shard == hungry; })) {
+    hungry_shards_.emplace_back(std::move(hungry));
+  }
+  return vs;
+}
+
+template <typename T>
+inline std::vector<T> QueueShard<T>::pop_front(std::size_t num,
+                                               uint64_t wake_seq) {
+  ScopedLock lock(&mutex_);
+  num_waiters_++;
+  while (container_.empty() && wake_seq_ == wake_seq) {
+    cv_.wait(&mutex_);
+  }
+  num_waiters_--;
+  return container_.try_pop_front(num);
+}
+
+template <typename T>
+inline void QueueShard<T>::wake_up() {
+  ScopedLock lock(&mutex_);
+  wake_seq_++;
+  cv_.signal_all();
+}
+
+template <typename T>
+inline DistributedQueue<T>::DistributedQueue()
+    : max_batch_size_(0),
+      flush_timeout_us_(0),
+      home_idx_(0),
+      next_push_idx_(0),
+      oldest_push_us_(0) {}
+
+template <typename T>
+inline DistributedQueue<T>::DistributedQueue(const DistributedQueue &o)
+    : DistributedQueue() {
+  *this = o;
+}
+
+template <typename T>
+inline DistributedQueue<T> &DistributedQueue<T>::operator=(
+    const DistributedQueue &o) {
+  flush();
+  ref_cnter_ = o.ref_cnter_;
+  shards_ = o.shards_;
+  max_batch_size_ = o.max_batch_size_;
+  flush_timeout_us_ = o.flush_timeout_us_;
+  pick_home();
+  return *this;
+}
+
+template <typename T>
+inline DistributedQueue<T>::DistributedQueue(DistributedQueue &&o)
+    : DistributedQueue() {
+  *this = std::move(o);
+}
+
+template <typename T>
+inline DistributedQueue<T> &DistributedQueue<T>::operator=(
+    DistributedQueue &&o) {
+  flush();
+  ref_cnter_ = std::move(o.ref_cnter_);
+  shards_ = std::move(o.shards_);
+  max_batch_size_ = o.max_batch_size_;
+  flush_timeout_us_ = o.flush_timeout_us_;
+  home_idx_ = o.home_idx_;
+  next_push_idx_ = o.next_push_idx_;
+  push_reqs_ = std::move(o.push_reqs_);
+  o.push_reqs_.clear();
+  oldest_push_us_ = o.oldest_push_us_;
+  return *this;
+}
+
+template <typename T>
+inline DistributedQueue<T>::~DistributedQueue() {
+  flush();
+}
+
+template <typename T>
+inline void DistributedQueue<T>::pick_home() {
+  // Spreads the consumers and producers of different handles across shards.
+  home_idx_ = shards_.empty() ? 0 : rdtsc() % shards_.size();
+  next_push_idx_ = home_idx_;
+}
+
+template <typename T>
+inline void DistributedQueue<T>::push(T v) {
+  auto now_us = microtime();
+  if (push_reqs_.empty()) {
+    oldest_push_us_ = now_us;
+  }
+  push_reqs_.emplace_back(std::move(v));
+  if (push_reqs_.size() >= max_batch_size_ ||
+      now_us - oldest_push_us_ >= flush_timeout_us_) {
+    flush();
+  }
+}
+
+template <typename T>
+inline void DistributedQueue<T>::flush() {
+  if (push_reqs_.empty()) {
+    return;
+  }
+  auto &shard = shards_[next_push_idx_++ % shards_.size()];
+  shard.run(&Shard::push_back_batch, std::move(push_reqs_));
+  push_reqs_.clear();
+}
+
+template <typename T>
+inline std::vector<T> DistributedQueue<T>::try_steal(std::size_t num) {
+  auto &home = shards_[home_idx_];
+  for (uint32_t i = 1; i < shards_.size(); i++) {
+    auto &victim = shards_[(home_idx_ + i) % shards_.size()];
+    auto vs = victim.run(&Shard::try_steal, num, home);
+    if (!vs.empty()) {
+      return vs;
+    }
+  }
+  return std::vector<T>();
+}
+
+template <typename T>
+inline std::vector<T> DistributedQueue<T>::pop(std::size_t num) {
+  // Nothing would ever satisfy the wait below.
+  if (unlikely(!num)) {
+    return {};
+  }
+  flush();
+  auto &home = shards_[home_idx_];
+  while (true) {
+    auto [vs, wake_seq] = home.run(&Shard::try_pop_front, num);
+    if (!vs.empty()) {
+      return std::move(vs);
+    }
+    // Any steal attempt that comes back empty subscribes the home shard to a
+    // wake-up, so the wait below can't miss elements pushed in the meantime.
+    vs = try_steal(num);
+    if (!vs.empty()) {
+      return std::move(vs);
+    }
+    vs = home.run(&Shard::pop_front, num, wake_seq);
+    if (!vs.empty()) {
+      return std::move(vs);
+    }
+  }
+}
+
+template <typename T>
+inline std::vector<T> DistributedQueue<T>::try_pop(std::size_t num) {
+  flush();
+  auto vs = shards_[home_idx_].run(&Shard::try_pop_front, num).first;
+  if (!vs.empty()) {
+    return vs;
+  }
+  return try_steal(num);
+}
+
+template <typename T>
+inline std::size_t DistributedQueue<T>::size() {
+  std::vector<Future<std::size_t>> futures;
+  futures.reserve(shards_.size());
+  for (auto &shard : shards_) {
+    futures.emplace_back(shard.run_async(&Shard::size));
+  }
+  std::size_t size = push_reqs_.size();
+  for (auto &future : futures) {
+    size += future.get();
+  }
+  return size;
+}
+
+template <typename T>
+template <class Archive>
+inline void DistributedQueue<T>::save(Archive &ar) const {
+  ar(ref_cnter_, shards_, max_batch_size_, flush_timeout_us_);
+}
+
+template <typename T>
+template <class Archive>
+inline void DistributedQueue<T>::load(Archive &ar) {
+  ar(ref_cnter_, shards_, max_batch_size_, flush_timeout_us_);
+  pick_home();
+}
+
+template <typename T>
+inline DistributedQueue<T> make_dis_queue(uint32_t num_shards,
+                                          uint32_t max_batch_size,
+                                          uint64_t flush_timeout_us,
+                                          bool pinned) {
+  using QueueType = DistributedQueue<T>;
+  BUG_ON(!num_shards || !max_batch_size);
+  QueueType queue;
+  queue.max_batch_size_ = max_batch_size;
+  queue.flush_timeout_us_ = flush_timeout_us;
+  queue.ref_cnter_ = make_proclet<typename QueueType::RefCnter>();
+  queue.shards_ = queue.ref_cnter_.run(
+      +[](typename QueueType::RefCnter &self, uint32_t num_shards,
+          bool pinned) {
+        std::vector<WeakProclet<typename QueueType::Shard>> weak_shards;
+        for (uint32_t i = 0; i < num_shards; i++) {
+          self.shards.emplace_back(
+              make_proclet<typename QueueType::Shard>(pinned));
+          weak_shards.emplace_back(self.shards.back().get_weak());
+        }
+        return weak_shards;
+      },
+      num_shards, pinned);
+  queue.pick_home();
+  return queue;
+}
+
+}  // namespace nu
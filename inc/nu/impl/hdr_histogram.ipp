@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <bit>
+
+namespace nu {
+
+inline uint32_t HdrHistogram::bucket_idx(uint64_t val) {
+  if (val < (1ULL << kSubBucketBits)) {
+    return val;
+  }
+  uint32_t shift = std::bit_width(val) - kSubBucketBits;
+  return shift * kHalfSubBucketCnt + (val >> shift);
+}
+
+inline void HdrHistogram::record(uint64_t val) {
+  val = std::min(val, kMaxValue);
+  cnts_[bucket_idx(val)]++;
+  total_cnt_++;
+  total_sum_ += val;
+  max_ = std::max(max_, val);
+}
+
+inline bool HdrHistogram::empty() const { return !total_cnt_; }
+
+inline uint64_t HdrHistogram::count() const { return total_cnt_; }
+
+inline uint64_t HdrHistogram::max() const { return max_; }
+
+inline uint64_t HdrHistogram::mean() const {
+  return total_cnt_ ? total_sum_ / total_cnt_ : 0;
+}
+
+}  // namespace nu
@@ -0,0 +1,7 @@
+namespace nu {
+
+constexpr uint64_t LZ4::compress_bound(uint64_t len) {
+  return len + len / 255 + 16;
+}
+
+}  // namespace nu
@@ -0,0 +1,254 @@
+#include <tuple>
+
+#include "nu/utils/scoped_lock.hpp"
+
+namespace nu {
+
+template <typename T>
+inline MicroProcletHost<T>::MicroProcletHost(uint32_t max_num_objs)
+    : max_num_objs_(max_num_objs), next_id_(0), num_objs_(0) {}
+
+template <typename T>
+template <typename... As>
+inline std::optional<MicroProcletID> MicroProcletHost<T>::create(As... args) {
+  if (unlikely(num_objs_.fetch_add(1) >= max_num_objs_)) {
+    num_objs_.fetch_sub(1);
+    return std::nullopt;
+  }
+  auto id = next_id_.fetch_add(1);
+  BUG_ON(!objs_.try_emplace(id, std::move(args)...));
+  return id;
+}
+
+template <typename T>
+template <typename... As>
+inline std::vector<MicroProcletID> MicroProcletHost<T>::create_batch(
+    uint32_t num, As... args) {
+  std::vector<MicroProcletID> ids;
+  ids.reserve(num);
+  while (ids.size() < num) {
+    auto id = create(args...);
+    if (unlikely(!id)) {
+      break;
+    }
+    ids.push_back(*id);
+  }
+  return ids;
+}
+
+template <typename T>
+inline ProcletID MicroProcletHost<T>::destroy(MicroProcletID id) {
+  if (likely(objs_.remove(id))) {
+    num_objs_.fetch_sub(1);
+    return to_proclet_id(get_runtime()->get_current_proclet_header());
+  }
+  std::optional<WeakProclet<MicroProcletHost>> forward;
+  {
+    ScopedLock lock(&split_mutex_);
+    if (unlikely(objs_.remove(id))) {
+      num_objs_.fetch_sub(1);
+      return to_proclet_id(get_runtime()->get_current_proclet_header());
+    }
+    forward = forwards_.get_and_remove(id);
+  }
+  BUG_ON(!forward);
+  return forward->run(&MicroProcletHost::destroy, id);
+}
+
+template <typename T>
+inline void MicroProcletHost<T>::adopt(MicroProcletID id, T obj) {
+  num_objs_.fetch_add(1);
+  BUG_ON(!objs_.try_emplace(id, std::move(obj)));
+}
+
+template <typename T>
+inline void MicroProcletHost<T>::split_to(MicroProcletID id,
+                                          WeakProclet<MicroProcletHost> dst) {
+  ScopedLock lock(&split_mutex_);
+  auto obj = objs_.get_and_remove(id);
+  if (likely(obj)) {
+    num_objs_.fetch_sub(1);
+    dst.run(&MicroProcletHost::adopt, id, std::move(*obj));
+  } else {
+    auto forward = forwards_.get_copy(id);
+    BUG_ON(!forward);
+    forward->run(&MicroProcletHost::split_to, id, dst);
+  }
+  forwards_.put(id, std::move(dst));
+}
+
+template <typename T>
+template <typename RetT, typename... S0s>
+inline RetT MicroProcletHost<T>::invoke(MicroProcletID id,
+                                        RetT (*fn)(T &, S0s...),
+                                        S0s... states) {
+  auto *obj = objs_.get(id);
+  if (likely(obj)) {
+    return fn(*obj, std::move(states)...);
+  }
+  std::optional<WeakProclet<MicroProcletHost>> forward;
+  {
+    ScopedLock lock(&split_mutex_);
+    obj = objs_.get(id);
+    if (!obj) {
+      forward = forwards_.get_copy(id);
+    }
+  }
+  if (unlikely(obj)) {
+    return fn(*obj, std::move(states)...);
+  }
+  BUG_ON(!forward);
+  return forward->__run(&MicroProcletHost::template invoke<RetT, S0s...>, id,
+                        fn, std::move(states)...);
+}
+
+template <typename T>
+inline MicroProclet<T>::MicroProclet() : id_(0) {}
+
+template <typename T>
+inline MicroProclet<T>::MicroProclet(WeakProclet<MicroProcletHost<T>> host,
+                                     MicroProcletID id)
+    : host_(std::move(host)), id_(id) {}
+
+template <typename T>
+inline MicroProclet<T>::operator bool() const {
+  return host_;
+}
+
+template <typename T>
+inline MicroProcletID MicroProclet<T>::get_id() const {
+  return id_;
+}
+
+template <typename T>
+inline ProcletID MicroProclet<T>::get_host_id() const {
+  return host_.get_id();
+}
+
+template <typename T>
+template <typename RetT, typename... S0s, typename... S1s>
+inline Future<RetT> MicroProclet<T>::run_async(RetT (*fn)(T &, S0s...),
+                                               S1s &&... states) {
+  return host_.__run_async(
+      &MicroProcletHost<T>::template invoke<RetT, S0s...>, id_, fn,
+      std::forward<S1s>(states)...);
+}
+
+template <typename T>
+template <typename RetT, typename... S0s, typename... S1s>
+inline RetT MicroProclet<T>::run(RetT (*fn)(T &, S0s...), S1s &&... states) {
+  return host_.__run(&MicroProcletHost<T>::template invoke<RetT, S0s...>, id_,
+                     fn, std::forward<S1s>(states)...);
+}
+
+template <typename T>
+template <class Archive>
+inline void MicroProclet<T>::serialize(Archive &ar) {
+  ar(host_, id_);
+}
+
+template <typename T>
+inline MicroProcletPool<T>::MicroProcletPool(uint64_t host_capacity,
+                                             uint32_t max_num_objs_per_host)
+    : host_capacity_(host_capacity),
+      max_num_objs_per_host_(max_num_objs_per_host) {}
+
+template <typename T>
+inline WeakProclet<MicroProcletHost<T>> MicroProcletPool<T>::get_free_host() {
+  ScopedLock lock(&mutex_);
+  if (unlikely(hosts_.empty())) {
+    hosts_.emplace_back(make_proclet<Host>(
+        std::make_tuple(max_num_objs_per_host_), false, host_capacity_));
+  }
+  return hosts_.back().get_weak();
+}
+
+template <typename T>
+inline void MicroProcletPool<T>::handle_full_host(
+    const WeakProclet<Host> &host) {
+  ScopedLock lock(&mutex_);
+  // Some other thread may have already added a new host.
+  if (hosts_.back().get_id() == host.get_id()) {
+    hosts_.emplace_back(make_proclet<Host>(
+        std::make_tuple(max_num_objs_per_host_), false, host_capacity_));
+  }
+}
+
+template <typename T>
+template <typename... As>
+inline MicroProclet<T> MicroProcletPool<T>::create(As &&... args) {
+  while (true) {
+    auto host = get_free_host();
+    auto id = host.run(&Host::template create<std::decay_t<As>...>, args...);
+    if (likely(id)) {
+      return MicroProclet<T>(std::move(host), *id);
+    }
+    handle_full_host(host);
+  }
+}
+
+template <typename T>
+template <typename... As>
+inline Future<MicroProclet<T>> MicroProcletPool<T>::create_async(
+    As &&... args) {
+  return nu::async([&, ... args = std::forward<As>(args)]() mutable {
+    return create(std::move(args)...);
+  });
+}
+
+template <typename T>
+template <typename... As>
+inline std::vector<MicroProclet<T>> MicroProcletPool<T>::create_batch(
+    uint32_t num, As &&... args) {
+  std::vector<MicroProclet<T>> micro_proclets;
+  micro_proclets.reserve(num);
+  while (micro_proclets.size() < num) {
+    auto host = get_free_host();
+    uint32_t num_wanted = num - micro_proclets.size();
+    auto ids = host.run(&Host::template create_batch<std::decay_t<As>...>,
+                        num_wanted, args...);
+    for (auto id : ids) {
+      micro_proclets.emplace_back(MicroProclet<T>(host, id));
+    }
+    if (unlikely(ids.size() < num_wanted)) {
+      handle_full_host(host);
+    }
+  }
+  return micro_proclets;
+}
+
+template <typename T>
+inline void MicroProcletPool<T>::destroy(
+    const MicroProclet<T> &micro_proclet) {
+  auto host = micro_proclet.host_;
+  auto holder_id = host.run(&Host::destroy, micro_proclet.id_);
+
+  std::optional<Proclet<Host>> split_host;
+  {
+    ScopedLock lock(&mutex_);
+    auto iter = split_hosts_.find(holder_id);
+    if (iter == split_hosts_.end()) {
+      return;
+    }
+    split_host = std::move(iter->second);
+    split_hosts_.erase(iter);
+  }
+  // The dedicated host is empty now, drop it outside of the lock.
+  split_host.reset();
+}
+
+template <typename T>
+inline MicroProclet<T> MicroProcletPool<T>::split(
+    const MicroProclet<T> &micro_proclet, std::optional<NodeIP> ip_hint) {
+  auto dst = make_proclet<Host>(std::make_tuple(static_cast<uint32_t>(1)),
+                                false, host_capacity_, ip_hint);
+  auto src = micro_proclet.host_;
+  src.run(&Host::split_to, micro_proclet.id_, dst.get_weak());
+  MicroProclet<T> split(dst.get_weak(), micro_proclet.id_);
+
+  ScopedLock lock(&mutex_);
+  split_hosts_.emplace(dst.get_id(), std::move(dst));
+  return split;
+}
+
+}  // namespace nu
@@ -0,0 +1,11 @@
+namespace nu {
+
+inline float MigrationCostModel::estimate_us(uint64_t mem_size,
+                                             uint32_t num_threads) const {
+  auto mem_mbs = mem_size / static_cast<float>(kOneMB);
+  return fixed_us_.load(std::memory_order_relaxed) +
+         per_mb_us_.load(std::memory_order_relaxed) * mem_mbs +
+         per_thread_us_.load(std::memory_order_relaxed) * num_threads;
+}
+
+}  // namespace nu
@@ -5,6 +5,10 @@
 
 namespace nu {
 
+inline const MigrationCostModel &Migrator::cost_model() const {
+  return cost_model_;
+}
+
 template <typename RetT>
 RPCReturnCode Migrator::load_thread_and_ret_val(ProcletHeader *dest_header,
                                                 void *raw_dest_ret_val_ptr,
@@ -28,7 +32,8 @@ RPCReturnCode Migrator::load_thread_and_ret_val(ProcletHeader *dest_header,
 
   auto *dest_ret_val_ptr = reinterpret_cast<RetT *>(raw_dest_ret_val_ptr);
   auto *ia_sstream = get_runtime()->archive_pool()->get_ia_sstream();
-  auto &[ret_ss, ia] = *ia_sstream;
+  auto &ret_ss = ia_sstream->ss;
+  auto &ia = ia_sstream->ia;
   ret_ss.span({reinterpret_cast<char *>(payload + nu_state_size + stack_len),
                payload_len - nu_state_size - stack_len});
   if constexpr (!std::is_same<RetT, void>::value) {
@@ -1,3 +1,6 @@
+extern "C" {
+#include <base/time.h>
+}
 #include <runtime.h>
 
 namespace nu {
@@ -18,4 +21,15 @@ inline bool PressureHandler::has_real_pressure() {
   return has_pressure() && !mock_;
 }
 
+inline void PressureHandler::update_candidate(ProcletHeader *header) {
+  auto now_tsc = rdtsc();
+  if (likely(now_tsc < header->util_update_tsc +
+                           kCandidateUpdateIntervalUs * cycles_per_us)) {
+    return;
+  }
+  header->util_update_tsc = now_tsc;
+  rebucket_candidate(header, Utility(header, header->total_mem_size(),
+                                     header->cpu_load.get_load()));
+}
+
 }  // namespace nu
@@ -32,8 +32,56 @@ inline void serialize(auto *oa_sstream, S1s &&... states) {
   *rpc_type = kProcletCall;
   ss.seekp(sizeof(RPCReqType));
 
-  auto &oa = oa_sstream->oa;
-  ((oa << std::forward<S1s>(states)), ...);
+  ((ProcletServer::serialize_arg(oa_sstream, std::forward<S1s>(states))), ...);
+}
+
+// The in-place arguments of a call that bounced off a stale location must be
+// pinned again to be resent. If the caller has been migrated in the meantime,
+// this thread follows it along with the serialized arguments, since the
+// in-place ones have moved along with the caller's heap.
+inline MigrationGuard repin_caller(ProcletHeader *caller_header,
+                                   ArchivePool<>::OASStream **oa_sstream) {
+  using CarriedArgs =
+      std::pair<std::string, std::vector<std::pair<uint64_t, uint64_t>>>;
+
+  auto optional_caller_guard =
+      get_runtime()->attach_and_disable_migration(caller_header);
+  if (likely(optional_caller_guard)) {
+    get_runtime()->detach();
+    return std::move(*optional_caller_guard);
+  }
+
+  auto *archive_pool = get_runtime()->archive_pool();
+  auto *carrier = archive_pool->get_oa_sstream();
+  {
+    CarriedArgs args;
+    args.first.assign((*oa_sstream)->ss.view().data(),
+                      (*oa_sstream)->ss.tellp());
+    for (auto &seg : (*oa_sstream)->bulk_segs) {
+      args.second.emplace_back(reinterpret_cast<uint64_t>(seg.iov_base),
+                               seg.iov_len);
+    }
+    carrier->oa << args;
+  }
+  archive_pool->put_oa_sstream(*oa_sstream);
+  auto view = carrier->ss.view();
+  RPCReturnBuffer buf(
+      std::span(reinterpret_cast<const std::byte *>(view.data()),
+                carrier->ss.tellp()),
+      [archive_pool, carrier] { archive_pool->put_oa_sstream(carrier); });
+
+  CarriedArgs carried;
+  auto caller_guard = Migrator::migrate_thread_and_ret_val<CarriedArgs>(
+      std::move(buf), to_proclet_id(caller_header), &carried, nullptr);
+  get_runtime()->detach();
+
+  // Now on the caller's new node.
+  *oa_sstream = get_runtime()->archive_pool()->get_oa_sstream();
+  (*oa_sstream)->ss.write(carried.first.data(), carried.first.size());
+  for (auto [addr, len] : carried.second) {
+    (*oa_sstream)->bulk_segs.emplace_back(reinterpret_cast<void *>(addr), len);
+  }
+  return caller_guard;
 }
 
 template <typename T>
@@ -47,9 +95,9 @@ void Proclet<T>::invoke_remote(MigrationGuard &&caller_guard, ProcletID id,
   auto *oa_sstream = get_runtime()->archive_pool()->get_oa_sstream();
   serialize(oa_sstream, std::forward<S1s>(states)...);
   get_runtime()->detach();
-  caller_guard.reset();
 
 retry:
+  auto &bulk_segs = oa_sstream->bulk_segs;
   auto states_view = oa_sstream->ss.view();
   auto states_data = reinterpret_cast<const std::byte *>(states_view.data());
   auto states_size = oa_sstream->ss.tellp();
@@ -59,9 +107,16 @@ retry:
   auto args_span = std::span(states_data, states_size);
 
   auto *client = get_runtime()->rpc_client_mgr()->get_by_proclet_id(id);
-  rc = client->Call(args_span, &return_buf);
+  // Only in-place arguments keep the caller pinned, and only until they are
+  // written, as the callee may call back into the caller being migrated.
+  rc = client->Call(args_span, bulk_segs, &return_buf,
+                    [&] { caller_guard.reset(); });
   if (unlikely(rc == kErrWrongClient)) {
-    get_runtime()->rpc_client_mgr()->invalidate_cache(id, client);
+    get_runtime()->rpc_client_mgr()->handle_wrong_client(id, client,
+                                                         return_buf);
+    if (!bulk_segs.empty()) {
+      caller_guard = repin_caller(caller_header, &oa_sstream);
+    }
     goto retry;
   }
   assert(rc == kOk);
@@ -87,9 +142,9 @@ RetT Proclet<T>::invoke_remote_with_ret(MigrationGuard &&caller_guard,
   auto *oa_sstream = get_runtime()->archive_pool()->get_oa_sstream();
   serialize(oa_sstream, std::forward<S1s>(states)...);
   get_runtime()->detach();
-  caller_guard.reset();
 
 retry:
+  auto &bulk_segs = oa_sstream->bulk_segs;
   auto states_view = oa_sstream->ss.view();
   auto states_data = reinterpret_cast<const std::byte *>(states_view.data());
   auto states_size = oa_sstream->ss.tellp();
@@ -99,9 +154,16 @@ retry:
   auto args_span = std::span(states_data, states_size);
 
   auto *client = get_runtime()->rpc_client_mgr()->get_by_proclet_id(id);
-  rc = client->Call(args_span, &return_buf);
+  // Only in-place arguments keep the caller pinned, and only until they are
+  // written, as the callee may call back into the caller being migrated.
+  rc = client->Call(args_span, bulk_segs, &return_buf,
+                    [&] { caller_guard.reset(); });
   if (unlikely(rc == kErrWrongClient)) {
-    get_runtime()->rpc_client_mgr()->invalidate_cache(id, client);
+    get_runtime()->rpc_client_mgr()->handle_wrong_client(id, client,
+                                                         return_buf);
+    if (!bulk_segs.empty()) {
+      caller_guard = repin_caller(caller_header, &oa_sstream);
+    }
     goto retry;
   }
   assert(rc == kOk);
@@ -114,7 +176,8 @@ retry:
         std::move(return_buf), to_proclet_id(caller_header), &ret, nullptr);
   } else {
     auto *ia_sstream = get_runtime()->archive_pool()->get_ia_sstream();
-    auto &[ret_ss, ia] = *ia_sstream;
+    auto &ret_ss = ia_sstream->ss;
+    auto &ia = ia_sstream->ia;
     auto return_span = return_buf.get_mut_buf();
     ret_ss.span(
         {reinterpret_cast<char *>(return_span.data()), return_span.size()});
@@ -131,7 +194,7 @@ retry:
 }
 
 template <typename T>
-inline Proclet<T>::Proclet() : id_(kNullProcletID) {}
+inline Proclet<T>::Proclet() : id_(kNullProcletID), weight_(0) {}
 
 template <typename T>
 inline Proclet<T>::~Proclet() {
@@ -140,30 +203,19 @@ inline Proclet<T>::~Proclet() {
 
 template <typename T>
 Proclet<T>::Proclet(const Proclet<T> &o)
-    : id_(o.id_) {
-  if (id_ != kNullProcletID) {
-    auto inc_ref_optional = update_ref_cnt(id_, 1);
-    if (inc_ref_optional) {
-      inc_ref_optional->get();
-    }
-  }
-}
+    : id_(o.id_), weight_(o.split_weight()) {}
 
 template <typename T>
 Proclet<T> &Proclet<T>::operator=(const Proclet<T> &o) {
   reset();
   id_ = o.id_;
-  if (id_ != kNullProcletID) {
-    auto inc_ref_optional = update_ref_cnt(id_, 1);
-    if (inc_ref_optional) {
-      inc_ref_optional->get();
-    }
-  }
+  weight_ = o.split_weight();
   return *this;
 }
 
 template <typename T>
-inline Proclet<T>::Proclet(Proclet<T> &&o) noexcept : id_(o.id_) {
+inline Proclet<T>::Proclet(Proclet<T> &&o) noexcept
+    : id_(o.id_), weight_(o.weight_.exchange(0)) {
   o.id_ = kNullProcletID;
 }
 
@@ -171,10 +223,46 @@ template <typename T>
 inline Proclet<T> &Proclet<T>::operator=(Proclet<T> &&o) noexcept {
   reset();
   id_ = o.id_;
+  weight_ = o.weight_.exchange(0);
   o.id_ = kNullProcletID;
   return *this;
 }
 
+template <typename T>
+uint32_t Proclet<T>::split_weight() const {
+  if (id_ == kNullProcletID) {
+    return 0;
+  }
+
+  auto *self = const_cast<Proclet<T> *>(this);
+  auto acquire_weight = [&] {
+    auto inc_ref_optional = self->update_ref_cnt(id_, kProcletInitialWeight);
+    if (inc_ref_optional) {
+      inc_ref_optional->get();
+    }
+  };
+
+  // A weak handle holds no weight to give away.
+  if (unlikely(!weight_.load(std::memory_order_relaxed))) {
+    acquire_weight();
+    return kProcletInitialWeight;
+  }
+
+  auto weight = weight_.load(std::memory_order_relaxed);
+  while (true) {
+    // Only the last unit of weight is left, top it up from the proclet.
+    if (unlikely(weight == 1)) {
+      acquire_weight();
+      weight = weight_.fetch_add(kProcletInitialWeight);
+      weight += kProcletInitialWeight;
+      continue;
+    }
+    if (likely(weight_.compare_exchange_weak(weight, weight - weight / 2))) {
+      return weight / 2;
+    }
+  }
+}
+
 template <typename T>
 template <typename... As>
 Proclet<T> Proclet<T>::__create(bool pinned, uint64_t capacity, NodeIP ip_hint,
@@ -205,6 +293,7 @@ Proclet<T> Proclet<T>::__create(bool pinned, uint64_t capacity, NodeIP ip_hint,
     std::tie(callee_id, server_ip) = *optional;
     get_runtime()->rpc_client_mgr()->update_cache(callee_id, server_ip);
     callee_proclet.id_ = callee_id;
+    callee_proclet.weight_ = kProcletInitialWeight;
 
     optional_caller_migration_guard =
         get_runtime()->attach_and_disable_migration(caller_header);
@@ -233,6 +322,52 @@ Proclet<T> Proclet<T>::__create(bool pinned, uint64_t capacity, NodeIP ip_hint,
   return callee_proclet;
 }
 
+template <typename T>
+Proclet<T> Proclet<T>::__restore(const std::string &path, bool pinned) {
+  Proclet<T> proclet;
+
+  ProcletHeader *caller_header;
+  {
+    MigrationGuard caller_migration_guard;
+
+    caller_header = caller_migration_guard.header();
+    get_runtime()->detach();
+  }
+
+  std::optional<MigrationGuard> optional_caller_migration_guard;
+  {
+    RuntimeSlabGuard slab_guard;
+
+    proclet.id_ = Migrator::restore_proclet_snapshot(path, pinned);
+    if (proclet.id_ != kNullProcletID) {
+      proclet.weight_ = kProcletInitialWeight;
+    }
+
+    optional_caller_migration_guard =
+        get_runtime()->attach_and_disable_migration(caller_header);
+    if (!optional_caller_migration_guard) {
+      RPCReturnBuffer return_buf;
+      *optional_caller_migration_guard =
+          Migrator::migrate_thread_and_ret_val<void>(
+              std::move(return_buf), to_proclet_id(caller_header), nullptr,
+              nullptr);
+    }
+  }
+
+  return proclet;
+}
+
+template <typename T>
+bool Proclet<T>::snapshot(const std::string &path) {
+  return __run</* MigrEn = */ false, /* CPUMon = */ false,
+               /* CPUSamp = */ false>(
+      +[](T &, std::string path) {
+        return Migrator::save_proclet_snapshot(
+            get_runtime()->get_current_proclet_header(), path);
+      },
+      path);
+}
+
 template <typename T>
 inline Proclet<T>::operator bool() const {
   return id_;
@@ -397,7 +532,7 @@ inline RetT Proclet<T>::__run(RetT (T::*md)(A0s...), A1s &&... args) {
 
 template <typename T>
 std::optional<Future<void>> Proclet<T>::update_ref_cnt(ProcletID id,
-                                                       int delta) {
+                                                       int64_t delta) {
   {
     MigrationGuard caller_migration_guard;
     auto *caller_header = caller_migration_guard.header();
@@ -429,7 +564,8 @@ std::optional<Future<void>> Proclet<T>::update_ref_cnt(ProcletID id,
 template <typename T>
 void Proclet<T>::reset() {
   if (id_ != kNullProcletID) {
-    auto dec_ref = update_ref_cnt(id_, -1);
+    auto weight = weight_.exchange(0);
+    auto dec_ref = update_ref_cnt(id_, -static_cast<int64_t>(weight));
     id_ = kNullProcletID;
     if (dec_ref) {
       dec_ref->get();
@@ -440,7 +576,8 @@ void Proclet<T>::reset() {
 template <typename T>
 std::optional<Future<void>> Proclet<T>::reset_async() {
   if (id_ != kNullProcletID) {
-    auto ret = update_ref_cnt(id_, -1);
+    auto weight = weight_.exchange(0);
+    auto ret = update_ref_cnt(id_, -static_cast<int64_t>(weight));
     id_ = kNullProcletID;
     return ret;
   }
@@ -457,14 +594,16 @@ inline void Proclet<T>::save(Archive &ar) const {
 template <typename T>
 template <class Archive>
 inline void Proclet<T>::save_move(Archive &ar) {
-  ar(id_);
+  ar(id_, weight_.exchange(0));
   id_ = kNullProcletID;
 }
 
 template <typename T>
 template <class Archive>
 inline void Proclet<T>::load(Archive &ar) {
-  ar(id_);
+  uint32_t weight;
+  ar(id_, weight);
+  weight_ = weight;
 }
 
 template <typename T>
@@ -563,4 +702,9 @@ inline Future<Proclet<T>> make_proclet_async(bool pinned,
   return nu::async([=] { return make_proclet<T>(pinned, capacity, ip_hint); });
 }
 
+template <typename T>
+inline Proclet<T> restore_proclet(const std::string &path, bool pinned) {
+  return Proclet<T>::__restore(path, pinned);
+}
+
 }  // namespace nu
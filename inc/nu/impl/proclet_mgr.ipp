@@ -36,6 +36,10 @@ inline SpinLock &ProcletHeader::migration_spin() {
   return proclet_migration_spin[global_idx()];
 }
 
+inline NodeIP &ProcletHeader::tombstone() {
+  return proclet_tombstones[global_idx()];
+}
+
 inline VAddrRange ProcletHeader::range() const {
   auto start_addr = reinterpret_cast<uint64_t>(this);
   auto end_addr = start_addr + capacity;
@@ -51,13 +55,6 @@ inline void ProcletManager::wait_until(ProcletHeader *proclet_header,
   proclet_header->spin_lock.unlock();
 }
 
-inline void ProcletManager::insert(void *proclet_base) {
-  ScopedLock lock(&spin_);
-  reinterpret_cast<ProcletHeader *>(proclet_base)->status() = kPresent;
-  num_present_proclets_++;
-  present_proclets_.push_back(proclet_base);
-}
-
 inline bool ProcletManager::remove_for_migration(void *proclet_base) {
   return __remove(proclet_base, kMigrating);
 }
@@ -66,27 +63,13 @@ inline bool ProcletManager::remove_for_destruction(void *proclet_base) {
   return __remove(proclet_base, kDestructing);
 }
 
-inline bool ProcletManager::__remove(void *proclet_base,
-                                     ProcletStatus new_status) {
-  ScopedLock lock(&spin_);
-  auto *proclet_header = reinterpret_cast<ProcletHeader *>(proclet_base);
-  auto &status = proclet_header->status();
-  if (status == kPresent) {
-    num_present_proclets_--;
-    status = new_status;
-    return true;
-  } else {
-    return false;
-  }
-}
-
 inline uint32_t ProcletManager::get_num_present_proclets() {
   return num_present_proclets_;
 }
 
-template <typename RetT>
-inline std::optional<RetT> ProcletManager::get_proclet_info(
-    const ProcletHeader *header, std::function<RetT(const ProcletHeader *)> f) {
+template <typename F>
+inline std::optional<std::invoke_result_t<F, const ProcletHeader *>>
+ProcletManager::get_proclet_info(const ProcletHeader *header, F &&f) {
   ScopedLock lock(&spin_);
   if (header->status() != kPresent) {
     return std::nullopt;
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -9,12 +10,53 @@
 #include "nu/ctrl.hpp"
 #include "nu/ctrl_client.hpp"
 #include "nu/migrator.hpp"
+#include "nu/pressure_handler.hpp"
 #include "nu/runtime.hpp"
 #include "nu/proclet_mgr.hpp"
 #include "nu/type_traits.hpp"
 
 namespace nu {
 
+template <typename S>
+inline void ProcletServer::serialize_arg(ArchivePool<>::OASStream *oa_sstream,
+                                         S &&s) {
+  using D = std::decay_t<S>;
+
+  if constexpr (BulkArg<D>) {
+    uint64_t size = s.size();
+    auto len = size * sizeof(typename D::value_type);
+    oa_sstream->oa << size;
+    if (len >= kMinBulkArgSize) {
+      auto *data = const_cast<typename D::value_type *>(s.data());
+      auto &segs = oa_sstream->bulk_segs;
+      segs.insert(segs.begin(), iovec{data, len});
+    } else {
+      oa_sstream->oa << cereal::binary_data(s.data(), len);
+    }
+  } else {
+    oa_sstream->oa << std::forward<S>(s);
+  }
+}
+
+template <typename S>
+inline void ProcletServer::deserialize_arg(ArchivePool<>::IASStream *ia_sstream,
+                                           S *s) {
+  if constexpr (BulkArg<S>) {
+    uint64_t size;
+    ia_sstream->ia >> size;
+    auto len = size * sizeof(typename S::value_type);
+    s->resize(size);
+    if (len >= kMinBulkArgSize) {
+      ia_sstream->bulk_cursor -= len;
+      memcpy(static_cast<void *>(s->data()), ia_sstream->bulk_cursor, len);
+    } else {
+      ia_sstream->ia >> cereal::binary_data(s->data(), len);
+    }
+  } else {
+    ia_sstream->ia >> *s;
+  }
+}
+
 template <typename Cls, typename... As>
 void ProcletServer::__construct_proclet(MigrationGuard *callee_guard, Cls *obj,
                                         ArchivePool<>::IASStream *ia_sstream,
@@ -29,8 +71,9 @@ void ProcletServer::__construct_proclet(MigrationGuard *callee_guard, Cls *obj,
     using ArgsTuple = std::tuple<std::decay_t<As>...>;
     auto *args = reinterpret_cast<ArgsTuple *>(alloca(sizeof(ArgsTuple)));
     new (args) ArgsTuple();
-    std::apply([&](auto &&... args) { ((ia_sstream->ia >> args), ...); },
-               *args);
+    std::apply(
+        [&](auto &&... args) { ((deserialize_arg(ia_sstream, &args)), ...); },
+        *args);
 
     callee_guard->enable_for([&] {
       std::apply(
@@ -127,7 +170,7 @@ void ProcletServer::construct_proclet_locally(MigrationGuard &&caller_guard,
 template <typename Cls>
 void ProcletServer::__update_ref_cnt(MigrationGuard *callee_guard, Cls *obj,
                                      ArchivePool<>::IASStream *ia_sstream,
-                                     RPCReturner returner, int delta,
+                                     RPCReturner returner, int64_t delta,
                                      bool *destructed) {
   auto *proclet_header = callee_guard->header();
   proclet_header->spin_lock.lock();
@@ -157,7 +200,7 @@ template <typename Cls>
 void ProcletServer::update_ref_cnt(ArchivePool<>::IASStream *ia_sstream,
                                    RPCReturner *returner) {
   ProcletID id;
-  int delta;
+  int64_t delta;
   ia_sstream->ia >> id >> delta;
 
   auto *proclet_base = to_proclet_base(id);
@@ -178,7 +221,7 @@ void ProcletServer::update_ref_cnt(ArchivePool<>::IASStream *ia_sstream,
   }
 
   if (proclet_not_found) {
-    get_runtime()->send_rpc_resp_wrong_client(returner);
+    get_runtime()->send_rpc_resp_wrong_client(proclet_header, returner);
   }
 }
 
@@ -186,7 +229,7 @@ template <typename Cls>
 void ProcletServer::update_ref_cnt_locally(MigrationGuard *callee_guard,
                                            ProcletHeader *caller_header,
                                            ProcletHeader *callee_header,
-                                           int delta) {
+                                           int64_t delta) {
   callee_header->spin_lock.lock();
   auto latest_cnt = (callee_header->ref_cnt += delta);
   BUG_ON(latest_cnt < 0);
@@ -256,8 +299,11 @@ void ProcletServer::__run_closure(MigrationGuard *callee_guard, Cls *obj,
   ia_sstream->ia >> fn;
 
   std::tuple<std::decay_t<S1s>...> states;
-  std::apply([&](auto &&... states) { ((ia_sstream->ia >> states), ...); },
-             states);
+  std::apply(
+      [&](auto &&... states) {
+        ((deserialize_arg(ia_sstream, &states)), ...);
+      },
+      states);
   auto apply_fn = [&] {
     std::apply(
         [&](auto &&... states) {
@@ -287,6 +333,7 @@ void ProcletServer::__run_closure(MigrationGuard *callee_guard, Cls *obj,
   callee_header->thread_cnt.dec_unsafe();
   if constexpr (CPUMon) {
     callee_header->cpu_load.end_monitor();
+    get_runtime()->pressure_handler()->update_candidate(callee_header);
   }
 }
 
@@ -307,7 +354,7 @@ void ProcletServer::run_closure(ArchivePool<>::IASStream *ia_sstream,
       ia_sstream, *returner);
 
   if (proclet_not_found) {
-    get_runtime()->send_rpc_resp_wrong_client(returner);
+    get_runtime()->send_rpc_resp_wrong_client(proclet_header, returner);
   }
 }
 
@@ -348,6 +395,7 @@ void ProcletServer::run_closure_locally(
     callee_header->thread_cnt.dec_unsafe();
     if constexpr (CPUMon) {
       callee_header->cpu_load.end_monitor();
+      get_runtime()->pressure_handler()->update_candidate(callee_header);
     }
 
     auto optional_caller_guard = get_runtime()->reattach_and_disable_migration(
@@ -394,6 +442,7 @@ void ProcletServer::run_closure_locally(
     callee_header->thread_cnt.dec_unsafe();
     if constexpr (CPUMon) {
       callee_header->cpu_load.end_monitor();
+      get_runtime()->pressure_handler()->update_candidate(callee_header);
     }
 
     auto optional_caller_guard = get_runtime()->reattach_and_disable_migration(
@@ -1,4 +1,12 @@
+#include <experimental/scope>
+
+extern "C" {
+#include <base/time.h>
+}
+
 #include "nu/commons.hpp"
+#include "nu/proclet_mgr.hpp"
+#include "nu/rem_ptr_cache.hpp"
 #include "nu/runtime.hpp"
 #include "nu/utils/caladan.hpp"
 
@@ -53,6 +61,10 @@ inline RemPtr<T>::RemPtr(T *raw_ptr) : raw_ptr_(raw_ptr) {
   proclet_.id_ = to_proclet_id(get_runtime()->get_current_proclet_header());
 }
 
+template <typename T>
+inline RemPtr<T>::RemPtr(WeakProclet<ErasedType> proclet, T *raw_ptr)
+    : proclet_(std::move(proclet)), raw_ptr_(raw_ptr) {}
+
 template <typename T>
 inline RemPtr<T>::operator bool() const {
   return raw_ptr_;
@@ -69,15 +81,62 @@ inline T RemPtr<T>::operator*() {
       +[](ErasedType &, T *raw_ptr) { return *raw_ptr; }, raw_ptr_);
 }
 
+template <typename T>
+inline T RemPtr<T>::read_cached(uint64_t lease_us) {
+  auto *cache = RemPtrCache<T>::get();
+  auto id = proclet_.get_id();
+  auto entry = cache->lookup(id, raw_ptr_);
+  if (entry && microtime() < entry->expiry_us) {
+    return std::move(entry->val);
+  }
+
+  // Only ships the object back if it has changed since the cached read.
+  auto known_version =
+      entry ? std::make_optional(entry->version) : std::nullopt;
+  auto [version, val] = proclet_.__run(
+      +[](ErasedType &, T *raw_ptr, std::optional<uint64_t> known_version) {
+        auto *header = get_runtime()->get_current_proclet_header();
+        // Read before the object, so that a racing write forces a refetch.
+        auto version = header->rem_ptr_version.load(std::memory_order_acquire);
+        return std::make_pair(version, known_version == version
+                                           ? std::nullopt
+                                           : std::make_optional(*raw_ptr));
+      },
+      raw_ptr_, known_version);
+  auto expiry_us = microtime() + lease_us;
+
+  if (!val) {
+    cache->renew(id, raw_ptr_, expiry_us);
+    return std::move(entry->val);
+  }
+  cache->update(id, raw_ptr_, *val, version, expiry_us);
+  return std::move(*val);
+}
+
+template <typename T>
+inline void RemPtr<T>::invalidate_cached() {
+  auto *cache = RemPtrCache<T>::get_if_exists();
+  if (unlikely(cache)) {
+    cache->invalidate(proclet_.get_id(), raw_ptr_);
+  }
+}
+
+inline void bump_rem_ptr_version() {
+  auto *header = get_runtime()->get_current_proclet_header();
+  header->rem_ptr_version.fetch_add(1, std::memory_order_release);
+}
+
 template <typename T>
 template <typename RetT, typename... S0s, typename... S1s>
 inline Future<RetT> RemPtr<T>::run_async(RetT (*fn)(T &, S0s...),
                                          S1s &&... states) {
+  invalidate_cached();
   auto raw_ptr_addr = reinterpret_cast<uintptr_t>(raw_ptr_);
   return proclet_.__run_async(
       +[](ErasedType &, uintptr_t raw_ptr_addr, RetT (*fn)(T &, S0s...),
           S1s &&... states) {
         auto *raw_ptr = reinterpret_cast<T *>(raw_ptr_addr);
+        auto bumper = std::experimental::scope_exit(bump_rem_ptr_version);
         return fn(*raw_ptr, std::forward<S1s>(states)...);
       },
       raw_ptr_addr, fn, std::forward<S1s>(states)...);
@@ -86,11 +145,13 @@ inline Future<RetT> RemPtr<T>::run_async(RetT (*fn)(T &, S0s...),
 template <typename T>
 template <typename RetT, typename... S0s, typename... S1s>
 inline RetT RemPtr<T>::run(RetT (*fn)(T &, S0s...), S1s &&... states) {
+  invalidate_cached();
   auto raw_ptr_addr = reinterpret_cast<uintptr_t>(raw_ptr_);
   return proclet_.__run(
       +[](ErasedType &, uintptr_t raw_ptr_addr, RetT (*fn)(T &, S0s...),
           S0s... states) {
         auto *raw_ptr = reinterpret_cast<T *>(raw_ptr_addr);
+        auto bumper = std::experimental::scope_exit(bump_rem_ptr_version);
         return fn(*raw_ptr, std::move(states)...);
       },
       raw_ptr_addr, fn, std::forward<S1s>(states)...);
@@ -0,0 +1,90 @@
+#include "nu/runtime.hpp"
+#include "nu/utils/scoped_lock.hpp"
+
+namespace nu {
+
+template <typename T>
+std::atomic<RemPtrCache<T> *> RemPtrCache<T>::instance_{nullptr};
+
+template <typename T>
+inline std::size_t RemPtrCache<T>::KeyHasher::operator()(const Key &k) const {
+  return std::hash<ProcletID>()(k.first) ^
+         std::hash<const T *>()(k.second);
+}
+
+template <typename T>
+inline RemPtrCache<T> *RemPtrCache<T>::get() {
+  auto *cache = instance_.load(std::memory_order_acquire);
+  if (likely(cache)) {
+    return cache;
+  }
+
+  RuntimeSlabGuard slab_guard;
+  auto *new_cache = new RemPtrCache();
+  if (unlikely(!instance_.compare_exchange_strong(cache, new_cache))) {
+    delete new_cache;
+    return cache;
+  }
+  return new_cache;
+}
+
+template <typename T>
+inline RemPtrCache<T> *RemPtrCache<T>::get_if_exists() {
+  return instance_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+inline std::optional<typename RemPtrCache<T>::Entry> RemPtrCache<T>::lookup(
+    ProcletID id, const T *raw_ptr) {
+  ScopedLock scope(&spin_);
+  auto iter = index_.find(Key(id, raw_ptr));
+  if (iter == index_.end()) {
+    return std::nullopt;
+  }
+  lru_.splice(lru_.begin(), lru_, iter->second);
+  // Copied out of the lock in the caller's context, i.e., into its own heap.
+  return iter->second->second;
+}
+
+template <typename T>
+inline void RemPtrCache<T>::update(ProcletID id, const T *raw_ptr,
+                                   const T &val, uint64_t version,
+                                   uint64_t expiry_us) {
+  RuntimeSlabGuard slab_guard;
+  ScopedLock scope(&spin_);
+  auto key = Key(id, raw_ptr);
+  auto iter = index_.find(key);
+  if (iter != index_.end()) {
+    lru_.erase(iter->second);
+    index_.erase(iter);
+  }
+  lru_.emplace_front(key, Entry{val, version, expiry_us});
+  index_.emplace(key, lru_.begin());
+  if (lru_.size() > kCapacity) {
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+template <typename T>
+inline void RemPtrCache<T>::renew(ProcletID id, const T *raw_ptr,
+                                  uint64_t expiry_us) {
+  ScopedLock scope(&spin_);
+  auto iter = index_.find(Key(id, raw_ptr));
+  if (iter != index_.end()) {
+    iter->second->second.expiry_us = expiry_us;
+  }
+}
+
+template <typename T>
+inline void RemPtrCache<T>::invalidate(ProcletID id, const T *raw_ptr) {
+  RuntimeSlabGuard slab_guard;
+  ScopedLock scope(&spin_);
+  auto iter = index_.find(Key(id, raw_ptr));
+  if (iter != index_.end()) {
+    lru_.erase(iter->second);
+    index_.erase(iter);
+  }
+}
+
+}  // namespace nu
@@ -9,6 +9,10 @@ inline RemRawPtr<T>::RemRawPtr() {}
 template <typename T>
 inline RemRawPtr<T>::RemRawPtr(T *raw_ptr) : RemPtr<T>(raw_ptr) {}
 
+template <typename T>
+inline RemRawPtr<T>::RemRawPtr(WeakProclet<ErasedType> proclet, T *raw_ptr)
+    : RemPtr<T>(std::move(proclet), raw_ptr) {}
+
 template <typename T>
 inline RemRawPtr<T>::RemRawPtr(const RemRawPtr<T> &o) : RemPtr<T>(o) {}
 
@@ -11,26 +11,32 @@ template <typename T>
 template <class Archive>
 inline void RemSharedPtr<T>::save_move(Archive &ar) {
   RemPtr<T>::save_move(ar);
-  ar(shared_ptr_);
+  ar(anchor_, weight_.exchange(0));
   RemPtr<T>::raw_ptr_ = nullptr;
 }
 
 template <typename T>
 template <class Archive>
 inline void RemSharedPtr<T>::load(Archive &ar) {
+  uint32_t weight;
   RemPtr<T>::load(ar);
-  ar(shared_ptr_);
+  ar(anchor_, weight);
+  weight_ = weight;
 }
 
 template <typename T>
 consteval auto get_reset_fn() {
-  return +[](T &t, std::shared_ptr<T> *shared_ptr) { delete shared_ptr; };
+  return +[](T &t, RemSharedPtrAnchor<T> *anchor, uint32_t weight) {
+    if (anchor->weight.fetch_sub(weight) == weight) {
+      delete anchor;
+    }
+  };
 }
 
 template <typename T>
-consteval auto get_copy_shared_ptr_fn() {
-  return +[](T &t, std::shared_ptr<T> *shared_ptr) {
-    return new std::shared_ptr<T>(*shared_ptr);
+consteval auto get_add_weight_fn() {
+  return +[](T &t, RemSharedPtrAnchor<T> *anchor, uint32_t weight) {
+    anchor->weight += weight;
   };
 }
 
@@ -40,12 +46,14 @@ inline RemSharedPtr<T>::RemSharedPtr() noexcept {}
 template <typename T>
 inline RemSharedPtr<T>::RemSharedPtr(std::shared_ptr<T> &&shared_ptr) noexcept
     : RemPtr<T>(shared_ptr.get()),
-      shared_ptr_(new std::shared_ptr<T>(std::move(shared_ptr))) {}
+      anchor_(new Anchor{std::move(shared_ptr), kInitialWeight}),
+      weight_(kInitialWeight) {}
 
 template <typename T>
-inline RemSharedPtr<T>::RemSharedPtr(std::shared_ptr<T> *shared_ptr)
-    : RemPtr<T>(shared_ptr ? shared_ptr->get() : nullptr),
-      shared_ptr_(shared_ptr) {}
+inline RemSharedPtr<T>::RemSharedPtr(Anchor *anchor)
+    : RemPtr<T>(anchor ? anchor->shared_ptr.get() : nullptr),
+      anchor_(anchor),
+      weight_(anchor ? kInitialWeight : 0) {}
 
 template <typename T>
 inline RemSharedPtr<T>::~RemSharedPtr() noexcept {
@@ -54,22 +62,23 @@ inline RemSharedPtr<T>::~RemSharedPtr() noexcept {
 
 template <typename T>
 inline RemSharedPtr<T>::RemSharedPtr(const RemSharedPtr<T> &o) noexcept
-    : RemPtr<T>(o) {
-  shared_ptr_ = RemPtr<T>::run(get_copy_shared_ptr_fn<T>(), o.shared_ptr_);
-}
+    : RemPtr<T>(o), anchor_(o.anchor_), weight_(o.split_weight()) {}
 
 template <typename T>
 inline RemSharedPtr<T> &RemSharedPtr<T>::operator=(
     const RemSharedPtr<T> &o) noexcept {
   reset();
   RemPtr<T>::operator=(o);
-  shared_ptr_ = RemPtr<T>::run(get_copy_shared_ptr_fn<T>(), o.shared_ptr_);
+  anchor_ = o.anchor_;
+  weight_ = o.split_weight();
   return *this;
 }
 
 template <typename T>
 inline RemSharedPtr<T>::RemSharedPtr(RemSharedPtr<T> &&o) noexcept
-    : RemPtr<T>(std::move(o)), shared_ptr_(o.shared_ptr_) {
+    : RemPtr<T>(std::move(o)),
+      anchor_(o.anchor_),
+      weight_(o.weight_.exchange(0)) {
   o.raw_ptr_ = nullptr;
 }
 
@@ -78,15 +87,38 @@ inline RemSharedPtr<T> &RemSharedPtr<T>::operator=(
     RemSharedPtr<T> &&o) noexcept {
   reset();
   RemPtr<T>::operator=(std::move(o));
-  shared_ptr_ = o.shared_ptr_;
+  anchor_ = o.anchor_;
+  weight_ = o.weight_.exchange(0);
   o.raw_ptr_ = nullptr;
   return *this;
 }
 
+template <typename T>
+uint32_t RemSharedPtr<T>::split_weight() const {
+  if (!RemPtr<T>::raw_ptr_) {
+    return 0;
+  }
+
+  auto weight = weight_.load(std::memory_order_relaxed);
+  while (true) {
+    // Only the last unit of weight is left, top it up from the anchor.
+    if (unlikely(weight == 1)) {
+      const_cast<RemSharedPtr<T> *>(this)->RemPtr<T>::run(
+          get_add_weight_fn<T>(), anchor_, kInitialWeight);
+      weight = weight_.fetch_add(kInitialWeight);
+      weight += kInitialWeight;
+      continue;
+    }
+    if (likely(weight_.compare_exchange_weak(weight, weight - weight / 2))) {
+      return weight / 2;
+    }
+  }
+}
+
 template <typename T>
 inline void RemSharedPtr<T>::reset() {
   if (RemPtr<T>::get()) {
-    RemPtr<T>::run(get_reset_fn<T>(), shared_ptr_);
+    RemPtr<T>::run(get_reset_fn<T>(), anchor_, weight_.exchange(0));
     RemPtr<T>::raw_ptr_ = nullptr;
   }
 }
@@ -94,7 +126,8 @@ inline void RemSharedPtr<T>::reset() {
 template <typename T>
 inline Future<void> RemSharedPtr<T>::reset_async() {
   if (RemPtr<T>::get()) {
-    auto future = RemPtr<T>::run_async(get_reset_fn<T>(), shared_ptr_);
+    auto future =
+        RemPtr<T>::run_async(get_reset_fn<T>(), anchor_, weight_.exchange(0));
     RemPtr<T>::raw_ptr_ = nullptr;
     return future;
   } else {
@@ -109,11 +142,12 @@ inline RemSharedPtr<T> make_rem_shared(Args &&... args) {
   if (unlikely(!raw_ptr)) {
     return RemSharedPtr<T>();
   }
-  auto *shared_ptr = new (std::nothrow) std::shared_ptr<T>(raw_ptr);
-  if (unlikely(!shared_ptr)) {
+  auto *anchor = new (std::nothrow) RemSharedPtrAnchor<T>{
+      std::shared_ptr<T>(raw_ptr), RemSharedPtr<T>::kInitialWeight};
+  if (unlikely(!anchor)) {
     return RemSharedPtr<T>();
   }
-  return RemSharedPtr<T>(shared_ptr);
+  return RemSharedPtr<T>(anchor);
 }
 
 }  // namespace nu
@@ -0,0 +1,200 @@
+#include <experimental/scope>
+
+extern "C" {
+#include <base/time.h>
+}
+
+#include "nu/utils/future.hpp"
+#include "nu/utils/scoped_lock.hpp"
+
+namespace nu {
+
+template <typename T>
+template <typename... As>
+inline ReplicaState<T>::ReplicaState(uint64_t version, As... args)
+    : obj(std::move(args)...), version(version) {}
+
+template <typename T>
+template <typename RetT, typename... S0s>
+inline RetT ReplicaState<T>::read(RetT (*fn)(const T &, S0s...),
+                                  S0s... states) {
+  lock.reader_lock();
+  auto unlocker = std::experimental::scope_exit([&] { lock.reader_unlock(); });
+  return fn(obj, std::move(states)...);
+}
+
+template <typename T>
+template <typename RetT, typename... S0s>
+inline RetT ReplicaState<T>::write(RetT (*fn)(T &, S0s...), S0s... states) {
+  std::optional<T> snapshot;
+  uint64_t new_version;
+  auto do_write = [&] {
+    lock.writer_lock();
+    auto unlocker =
+        std::experimental::scope_exit([&] { lock.writer_unlock(); });
+    auto cleaner = std::experimental::scope_exit([&] {
+      new_version = ++version;
+      snapshot.emplace(obj);
+    });
+    return fn(obj, std::move(states)...);
+  };
+  auto refresh_replicas = [&] {
+    // Refreshes are ordered by the versions, stale ones are dropped.
+    ScopedLock scope(&replicas_mutex);
+    std::vector<Future<void>> futures;
+    futures.reserve(replicas.size());
+    for (auto &replica : replicas) {
+      futures.emplace_back(
+          replica.run_async(&ReplicaState::refresh, *snapshot, new_version));
+    }
+  };
+
+  if constexpr (std::is_void_v<RetT>) {
+    do_write();
+    refresh_replicas();
+  } else {
+    auto ret = do_write();
+    refresh_replicas();
+    return ret;
+  }
+}
+
+template <typename T>
+inline void ReplicaState<T>::refresh(T new_obj, uint64_t new_version) {
+  lock.writer_lock();
+  if (new_version > version) {
+    obj = std::move(new_obj);
+    version = new_version;
+  }
+  lock.writer_unlock();
+}
+
+template <typename T>
+inline std::vector<WeakProclet<ReplicaState<T>>> ReplicaState<T>::add_replica(
+    NodeIP ip_hint) {
+  ScopedLock scope(&replicas_mutex);
+  lock.reader_lock();
+  auto snapshot = obj;
+  auto snapshot_version = version;
+  lock.reader_unlock();
+  replicas.emplace_back(
+      make_proclet<ReplicaState>(std::make_tuple(snapshot_version, snapshot),
+                                 false, std::nullopt, ip_hint));
+  return std::vector<WeakProclet<ReplicaState>>(replicas.begin(),
+                                                replicas.end());
+}
+
+template <typename T>
+inline std::vector<WeakProclet<ReplicaState<T>>>
+ReplicaState<T>::get_replicas() {
+  ScopedLock scope(&replicas_mutex);
+  return std::vector<WeakProclet<ReplicaState>>(replicas.begin(),
+                                                replicas.end());
+}
+
+template <typename T>
+inline ReplicatedProclet<T>::ReplicatedProclet() {}
+
+template <typename T>
+inline ReplicatedProclet<T>::ReplicatedProclet(Proclet<State> &&primary)
+    : primary_(std::move(primary)) {}
+
+template <typename T>
+inline ReplicatedProclet<T>::operator bool() const {
+  return primary_;
+}
+
+template <typename T>
+inline ProcletID ReplicatedProclet<T>::get_id() const {
+  return primary_.get_id();
+}
+
+template <typename T>
+inline uint32_t ReplicatedProclet<T>::get_num_replicas() const {
+  return replicas_.size();
+}
+
+template <typename T>
+inline void ReplicatedProclet<T>::replicate(NodeIP ip_hint) {
+  replicas_ = primary_.run(&State::add_replica, ip_hint);
+}
+
+template <typename T>
+inline void ReplicatedProclet<T>::refresh_replicas() {
+  replicas_ = primary_.run(&State::get_replicas);
+}
+
+template <typename T>
+inline Proclet<ReplicaState<T>> &ReplicatedProclet<T>::pick_read_target() {
+  if (primary_.is_local()) {
+    return primary_;
+  }
+  for (auto &replica : replicas_) {
+    if (replica.is_local()) {
+      return replica;
+    }
+  }
+  auto idx = rdtsc() % (replicas_.size() + 1);
+  return idx == replicas_.size() ? primary_ : replicas_[idx];
+}
+
+template <typename T>
+template <typename RetT, typename... S0s, typename... S1s>
+inline RetT ReplicatedProclet<T>::run(RetT (*fn)(const T &, S0s...),
+                                      S1s &&... states) {
+  return pick_read_target().__run(&State::template read<RetT, S0s...>, fn,
+                                  std::forward<S1s>(states)...);
+}
+
+template <typename T>
+template <typename RetT, typename... A0s, typename... A1s>
+inline RetT ReplicatedProclet<T>::run(RetT (T::*md)(A0s...) const,
+                                      A1s &&... args) {
+  MethodPtr<decltype(md)> method_ptr;
+  method_ptr.ptr = md;
+  return run(
+      +[](const T &t, decltype(method_ptr) method_ptr, A0s... args) {
+        return (t.*(method_ptr.ptr))(std::move(args)...);
+      },
+      method_ptr, std::forward<A1s>(args)...);
+}
+
+template <typename T>
+template <typename RetT, typename... S0s, typename... S1s>
+inline RetT ReplicatedProclet<T>::run(RetT (*fn)(T &, S0s...),
+                                      S1s &&... states) {
+  return primary_.__run(&State::template write<RetT, S0s...>, fn,
+                        std::forward<S1s>(states)...);
+}
+
+template <typename T>
+template <typename RetT, typename... A0s, typename... A1s>
+inline RetT ReplicatedProclet<T>::run(RetT (T::*md)(A0s...), A1s &&... args) {
+  MethodPtr<decltype(md)> method_ptr;
+  method_ptr.ptr = md;
+  return run(
+      +[](T &t, decltype(method_ptr) method_ptr, A0s... args) {
+        return (t.*(method_ptr.ptr))(std::move(args)...);
+      },
+      method_ptr, std::forward<A1s>(args)...);
+}
+
+template <typename T>
+template <class Archive>
+inline void ReplicatedProclet<T>::serialize(Archive &ar) {
+  ar(primary_, replicas_);
+}
+
+template <typename T, typename... As>
+inline ReplicatedProclet<T> make_replicated_proclet(
+    uint32_t num_replicas, std::tuple<As...> args_tuple) {
+  auto primary = make_proclet<ReplicaState<T>>(
+      std::tuple_cat(std::make_tuple(static_cast<uint64_t>(0)), args_tuple));
+  ReplicatedProclet<T> replicated(std::move(primary));
+  for (uint32_t i = 0; i < num_replicas; i++) {
+    replicated.replicate();
+  }
+  return replicated;
+}
+
+}  // namespace nu
@@ -24,7 +24,8 @@ class RPCServerWorker {
   };
 
   rt::Spin lock_;
-  std::unique_ptr<rt::TcpConn> c_;
+  uint32_t client_ip_;
+  std::unique_ptr<RPCConn> c_;
   nu::RPCHandler &handler_;
   bool close_;
   Counter &counter_;
@@ -43,16 +44,20 @@ inline void RPCServerWorker::Return(RPCReturnCode rc, RPCReturnBuffer &&buf,
   wake_sender_.Wake();
 }
 
-inline void RPCFlow::Call(std::span<const std::byte> src, RPCCompletion *c) {
+inline void RPCFlow::Call(std::span<const std::byte> src,
+                          std::span<const iovec> bulk, RPCCompletion *c) {
   rt::SpinGuard guard(&lock_);
-  reqs_.emplace(req_ctx{src, c});
+  reqs_.emplace(req_ctx{src, bulk, c});
   if (sent_count_ - recv_count_ < credits_) wake_sender_.Wake();
 }
 
 }  // namespace rpc_internal
 
-inline RPCReturner::RPCReturner(void *rpc_server, std::size_t completion_data)
-    : rpc_server_(rpc_server), completion_data_(completion_data) {}
+inline RPCReturner::RPCReturner(void *rpc_server, uint32_t client_ip,
+                                std::size_t completion_data)
+    : rpc_server_(rpc_server),
+      client_ip_(client_ip),
+      completion_data_(completion_data) {}
 
 inline void RPCReturner::Return(RPCReturnCode rc,
                                 std::span<const std::byte> buf,
@@ -69,6 +74,13 @@ inline void RPCReturner::Return(RPCReturnCode rc) {
   rpc_server->Return(rc, RPCReturnBuffer(), completion_data_);
 }
 
+inline void RPCClient::CompleteDirectly(std::size_t completion_data,
+                                        RPCReturnCode rc,
+                                        std::span<const std::byte> buf) {
+  auto *completion = reinterpret_cast<RPCCompletion *>(completion_data);
+  completion->Done(rc, buf);
+}
+
 inline RPCReturnCode RPCClient::Call(std::span<const std::byte> args,
                                      RPCCallback &&callback) {
   RPCCompletion completion(std::move(callback));
@@ -76,9 +88,9 @@ inline RPCReturnCode RPCClient::Call(std::span<const std::byte> args,
     rt::Preempt p;
     if (!p.IsHeld()) {
       rt::PreemptGuardAndPark guard(&p);
-      flows_[p.get_cpu()]->Call(args, &completion);
+      flows_[p.get_cpu()]->Call(args, {}, &completion);
     } else {
-      flows_[p.get_cpu()]->Call(args, &completion);
+      flows_[p.get_cpu()]->Call(args, {}, &completion);
     }
   }
   return completion.get_return_code();
@@ -91,12 +103,36 @@ inline RPCReturnCode RPCClient::Call(std::span<const std::byte> args,
     rt::Preempt p;
     if (!p.IsHeld()) {
       rt::PreemptGuardAndPark guard(&p);
-      flows_[p.get_cpu()]->Call(args, &completion);
+      flows_[p.get_cpu()]->Call(args, {}, &completion);
     } else {
-      flows_[p.get_cpu()]->Call(args, &completion);
+      flows_[p.get_cpu()]->Call(args, {}, &completion);
     }
   }
   return completion.get_return_code();
 }
 
+inline RPCReturnCode RPCClient::Call(std::span<const std::byte> args,
+                                     std::span<const iovec> bulk_args,
+                                     RPCReturnBuffer *return_buf,
+                                     std::move_only_function<void()> &&sent_fn) {
+  if (bulk_args.empty()) {
+    sent_fn();
+    return Call(args, return_buf);
+  }
+
+  RPCCompletion completion(return_buf, /* tracked = */ true);
+  {
+    rt::Preempt p;
+    if (!p.IsHeld()) {
+      rt::PreemptGuard guard(&p);
+      flows_[p.get_cpu()]->Call(args, bulk_args, &completion);
+    } else {
+      flows_[p.get_cpu()]->Call(args, bulk_args, &completion);
+    }
+  }
+  completion.WaitSent();
+  sent_fn();
+  return completion.WaitDone();
+}
+
 }  // namespace nu
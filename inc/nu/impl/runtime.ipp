@@ -187,6 +187,11 @@ inline void Runtime::detach() {
 
 inline std::optional<MigrationGuard> Runtime::__reattach_and_disable_migration(
     ProcletHeader *new_header) {
+  if (unlikely(new_header &&
+               Caladan::access_once(new_header->status()) == kSpilled)) {
+    unspill(new_header);
+  }
+
   Caladan::PreemptGuard g;
 
   auto *old_header = caladan_->thread_set_owner_proclet(caladan_->thread_self(),
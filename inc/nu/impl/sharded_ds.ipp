@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <experimental/scope>
+#include <iterator>
+#include <unordered_map>
+
+#include "nu/utils/scoped_lock.hpp"
+
+namespace nu {
+
+template <GeneralContainerBased Container>
+inline GeneralShard<Container>::GeneralShard(WeakProclet<Mapping> mapping,
+                                             uint32_t max_shard_size,
+                                             std::optional<Key> l_key,
+                                             std::optional<Key> r_key,
+                                             Container container)
+    : mapping_(std::move(mapping)),
+      max_shard_size_(max_shard_size),
+      l_key_(std::move(l_key)),
+      r_key_(std::move(r_key)),
+      drained_(false),
+      container_(std::move(container)) {}
+
+template <GeneralContainerBased Container>
+inline const typename GeneralShard<Container>::Key &
+GeneralShard<Container>::to_key(const DataEntry &entry) {
+  if constexpr (HasVal<Impl>) {
+    return entry.first;
+  } else {
+    return entry;
+  }
+}
+
+template <GeneralContainerBased Container>
+inline bool GeneralShard<Container>::owns(const Key &k) const {
+  return (!l_key_ || !(k < *l_key_)) && (!r_key_ || k < *r_key_);
+}
+
+template <GeneralContainerBased Container>
+inline std::vector<typename GeneralShard<Container>::DataEntry>
+GeneralShard<Container>::try_insert_batch(
+    std::vector<DataEntry> reqs) requires InsertAble<Impl> {
+  std::vector<DataEntry> rejected;
+  bool full = false;
+
+  lock_.reader_lock();
+  if (unlikely(drained_)) {
+    lock_.reader_unlock();
+    return reqs;
+  }
+  auto owned_end = std::stable_partition(
+      reqs.begin(), reqs.end(), [&](auto &req) { return owns(to_key(req)); });
+  rejected.insert(rejected.end(), std::make_move_iterator(owned_end),
+                  std::make_move_iterator(reqs.end()));
+  reqs.erase(owned_end, reqs.end());
+  auto num_owned = reqs.size();
+  if (likely(num_owned)) {
+    full = !container_.insert_batch_if(
+        [&](std::size_t size) {
+          return !size || size + num_owned <= max_shard_size_;
+        },
+        reqs);
+    if (unlikely(full)) {
+      rejected.insert(rejected.end(), std::make_move_iterator(reqs.begin()),
+                      std::make_move_iterator(reqs.end()));
+    }
+  }
+  lock_.reader_unlock();
+
+  if (unlikely(full)) {
+    split(num_owned);
+  }
+  return rejected;
+}
+
+template <GeneralContainerBased Container>
+inline std::vector<typename GeneralShard<Container>::Val>
+GeneralShard<Container>::try_push_back_batch(
+    std::vector<Val> reqs) requires PushBackAble<Impl> {
+  lock_.reader_lock();
+  // Only the tail shard accepts push_backs.
+  if (unlikely(drained_ || r_key_)) {
+    lock_.reader_unlock();
+    return reqs;
+  }
+  auto num = reqs.size();
+  auto pushed = container_
+                    .push_back_batch_if(
+                        [&](std::size_t size) {
+                          return !size || size + num <= max_shard_size_;
+                        },
+                        reqs)
+                    .first;
+  lock_.reader_unlock();
+
+  if (likely(pushed)) {
+    return std::vector<Val>();
+  }
+  split(num);
+  return reqs;
+}
+
+template <GeneralContainerBased Container>
+inline std::optional<bool> GeneralShard<Container>::try_erase(
+    Key k) requires EraseAble<Impl> {
+  lock_.reader_lock();
+  if (unlikely(drained_ || !owns(k))) {
+    lock_.reader_unlock();
+    return std::nullopt;
+  }
+  auto erased = container_.erase(std::move(k));
+  auto size = container_.size();
+  lock_.reader_unlock();
+
+  // Only probes the successor when crossing the threshold or halving below it
+  // to avoid paying a round trip on every erase of an already small shard.
+  if (erased && size * kMergeRatio < max_shard_size_ &&
+      ((size + 1) * kMergeRatio >= max_shard_size_ || !(size & (size - 1)))) {
+    try_merge();
+  }
+  return erased;
+}
+
+template <GeneralContainerBased Container>
+template <typename RetT, typename... S0s>
+inline std::optional<RetT> GeneralShard<Container>::try_compute_on(
+    Key k, RetT (*fn)(Impl &, Key, S0s...), S0s... states) {
+  lock_.reader_lock();
+  auto unlocker = std::experimental::scope_exit([&] { lock_.reader_unlock(); });
+  if (unlikely(drained_ || !owns(k))) {
+    return std::nullopt;
+  }
+  return container_.compute(fn, std::move(k), std::move(states)...);
+}
+
+template <GeneralContainerBased Container>
+template <typename RetT, typename... S0s>
+inline RetT GeneralShard<Container>::compute(RetT (*fn)(Impl &, S0s...),
+                                             S0s... states) {
+  lock_.reader_lock();
+  auto unlocker = std::experimental::scope_exit([&] { lock_.reader_unlock(); });
+  return container_.compute(fn, std::move(states)...);
+}
+
+template <GeneralContainerBased Container>
+inline std::optional<
+    std::pair<std::optional<typename GeneralShard<Container>::Key>, Container>>
+GeneralShard<Container>::try_drain(Key l_key, std::size_t max_size) {
+  lock_.writer_lock();
+  auto unlocker = std::experimental::scope_exit([&] { lock_.writer_unlock(); });
+  if (unlikely(drained_ || l_key_ != l_key || container_.size() > max_size)) {
+    return std::nullopt;
+  }
+  drained_ = true;
+  return std::make_pair(r_key_, std::move(container_));
+}
+
+template <GeneralContainerBased Container>
+inline void GeneralShard<Container>::split(std::size_t num_incoming) {
+  lock_.writer_lock();
+  auto unlocker = std::experimental::scope_exit([&] { lock_.writer_unlock(); });
+  // Some other thread may have already split the shard.
+  if (unlikely(drained_ ||
+               container_.size() + num_incoming <= max_shard_size_)) {
+    return;
+  }
+  if constexpr (PushBackAble<Impl>) {
+    if (r_key_) {
+      return;
+    }
+  }
+
+  Key mid_k;
+  Container latter_half;
+  container_.split(&mid_k, &latter_half);
+  auto new_shard = make_proclet<GeneralShard>(
+      std::make_tuple(mapping_, max_shard_size_, std::optional<Key>(mid_k),
+                      r_key_, std::move(latter_half)));
+  // Registers the new shard before shrinking the range, so that callers
+  // rejected by this shard always find the new owner.
+  mapping_.run(&Mapping::add_shard, std::optional<Key>(mid_k),
+               std::move(new_shard));
+  r_key_ = std::move(mid_k);
+}
+
+template <GeneralContainerBased Container>
+inline void GeneralShard<Container>::try_merge() {
+  lock_.writer_lock();
+  auto unlocker = std::experimental::scope_exit([&] { lock_.writer_unlock(); });
+  if (unlikely(drained_ || !r_key_)) {
+    return;
+  }
+  auto size = container_.size();
+  if (unlikely(size * kMergeRatio >= max_shard_size_)) {
+    return;
+  }
+
+  // Merges only go rightwards, so there can't be a cycle of shards waiting
+  // for each other's locks.
+  auto successor = mapping_.run(&Mapping::get_shard, *r_key_);
+  if (unlikely(!successor)) {
+    return;
+  }
+  // Leaves some headroom to avoid an immediate re-split.
+  auto max_merged_size = max_shard_size_ - max_shard_size_ / kMergeRatio;
+  auto drained =
+      successor->run(&GeneralShard::try_drain, *r_key_,
+                     static_cast<std::size_t>(max_merged_size - size));
+  if (!drained) {
+    return;
+  }
+  auto old_r_key = std::move(*r_key_);
+  container_.merge(std::move(drained->second));
+  r_key_ = std::move(drained->first);
+  mapping_.run(&Mapping::retire_shard, std::move(old_r_key));
+}
+
+template <GeneralContainerBased Container>
+inline ShardingMapping<Container>::ShardingMapping() : version_(0) {}
+
+template <GeneralContainerBased Container>
+inline typename ShardingMapping<Container>::Snapshot
+ShardingMapping<Container>::get_all_shards(
+    std::optional<uint64_t> released_version) {
+  // Destroyed after the lock is released.
+  std::vector<Proclet<Shard>> freed_shards;
+  ScopedLock lock(&mutex_);
+  if (released_version) {
+    __release_snapshot(*released_version);
+    freed_shards = pop_unreachable_shards();
+  }
+  snapshot_refs_[version_]++;
+
+  ShardList shards;
+  shards.reserve(mapping_.size());
+  for (auto &[l_key, shard] : mapping_) {
+    shards.emplace_back(l_key, shard.get_weak());
+  }
+  return Snapshot(version_, std::move(shards));
+}
+
+template <GeneralContainerBased Container>
+inline void ShardingMapping<Container>::release_snapshot(uint64_t version) {
+  std::vector<Proclet<Shard>> freed_shards;
+  ScopedLock lock(&mutex_);
+  __release_snapshot(version);
+  freed_shards = pop_unreachable_shards();
+}
+
+template <GeneralContainerBased Container>
+inline void ShardingMapping<Container>::__release_snapshot(uint64_t version) {
+  auto iter = snapshot_refs_.find(version);
+  BUG_ON(iter == snapshot_refs_.end());
+  if (!--iter->second) {
+    snapshot_refs_.erase(iter);
+  }
+}
+
+template <GeneralContainerBased Container>
+inline std::vector<Proclet<typename ShardingMapping<Container>::Shard>>
+ShardingMapping<Container>::pop_unreachable_shards() {
+  // A snapshot taken at version v holds the shards retired after v.
+  auto oldest_version =
+      snapshot_refs_.empty() ? version_ : snapshot_refs_.begin()->first;
+  std::vector<Proclet<Shard>> shards;
+  while (!retired_shards_.empty() &&
+         retired_shards_.front().first <= oldest_version) {
+    shards.emplace_back(std::move(retired_shards_.front().second));
+    retired_shards_.pop_front();
+  }
+  return shards;
+}
+
+template <GeneralContainerBased Container>
+inline std::optional<WeakProclet<typename ShardingMapping<Container>::Shard>>
+ShardingMapping<Container>::get_shard(Key l_key) {
+  ScopedLock lock(&mutex_);
+  auto iter = mapping_.find(l_key);
+  if (unlikely(iter == mapping_.end())) {
+    return std::nullopt;
+  }
+  return iter->second.get_weak();
+}
+
+template <GeneralContainerBased Container>
+inline void ShardingMapping<Container>::add_shard(std::optional<Key> l_key,
+                                                 Proclet<Shard> shard) {
+  ScopedLock lock(&mutex_);
+  BUG_ON(!mapping_.try_emplace(std::move(l_key), std::move(shard)).second);
+}
+
+template <GeneralContainerBased Container>
+inline void ShardingMapping<Container>::retire_shard(Key l_key) {
+  std::vector<Proclet<Shard>> freed_shards;
+  ScopedLock lock(&mutex_);
+  auto iter = mapping_.find(l_key);
+  BUG_ON(iter == mapping_.end());
+  retired_shards_.emplace_back(++version_, std::move(iter->second));
+  mapping_.erase(iter);
+  freed_shards = pop_unreachable_shards();
+}
+
+template <typename Container>
+inline ShardedDataStructure<Container>::ShardedDataStructure()
+    : max_batch_size_(0) {}
+
+template <typename Container>
+inline ShardedDataStructure<Container>::ShardedDataStructure(
+    uint32_t max_shard_size, uint32_t max_batch_size)
+    : max_batch_size_(max_batch_size) {
+  // A batch must fit into either half of a split shard.
+  BUG_ON(!max_batch_size || max_batch_size > max_shard_size / 2);
+  mapping_ = make_proclet<Mapping>();
+  auto shard = make_proclet<Shard>(std::make_tuple(
+      mapping_.get_weak(), max_shard_size, std::optional<Key>(),
+      std::optional<Key>(), Container()));
+  mapping_.run(&Mapping::add_shard, std::optional<Key>(), std::move(shard));
+}
+
+template <typename Container>
+inline ShardedDataStructure<Container>::ShardedDataStructure(
+    const ShardedDataStructure &o)
+    : mapping_(o.mapping_), max_batch_size_(o.max_batch_size_) {}
+
+template <typename Container>
+inline ShardedDataStructure<Container> &
+ShardedDataStructure<Container>::operator=(const ShardedDataStructure &o) {
+  if (mapping_) {
+    flush();
+    release_mapping();
+  }
+  mapping_ = o.mapping_;
+  max_batch_size_ = o.max_batch_size_;
+  return *this;
+}
+
+template <typename Container>
+inline ShardedDataStructure<Container>::ShardedDataStructure(
+    ShardedDataStructure &&o)
+    : mapping_(std::move(o.mapping_)),
+      max_batch_size_(o.max_batch_size_),
+      key_to_shards_(std::move(o.key_to_shards_)),
+      mapping_version_(std::exchange(o.mapping_version_, std::nullopt)),
+      insert_reqs_(std::move(o.insert_reqs_)),
+      push_back_reqs_(std::move(o.push_back_reqs_)) {}
+
+template <typename Container>
+inline ShardedDataStructure<Container> &
+ShardedDataStructure<Container>::operator=(ShardedDataStructure &&o) {
+  if (mapping_) {
+    flush();
+    release_mapping();
+  }
+  mapping_ = std::move(o.mapping_);
+  max_batch_size_ = o.max_batch_size_;
+  key_to_shards_ = std::move(o.key_to_shards_);
+  mapping_version_ = std::exchange(o.mapping_version_, std::nullopt);
+  insert_reqs_ = std::move(o.insert_reqs_);
+  push_back_reqs_ = std::move(o.push_back_reqs_);
+  return *this;
+}
+
+template <typename Container>
+inline ShardedDataStructure<Container>::~ShardedDataStructure() {
+  if (mapping_) {
+    flush();
+    release_mapping();
+  }
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::sync_mapping() {
+  key_to_shards_.clear();
+  auto [version, shards] =
+      mapping_.run(&Mapping::get_all_shards, mapping_version_);
+  mapping_version_ = version;
+  for (auto &[l_key, shard] : shards) {
+    key_to_shards_.emplace(std::move(l_key), std::move(shard));
+  }
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::release_mapping() {
+  key_to_shards_.clear();
+  if (mapping_version_) {
+    mapping_.run(&Mapping::release_snapshot, *mapping_version_);
+    mapping_version_.reset();
+  }
+}
+
+template <typename Container>
+inline WeakProclet<typename ShardedDataStructure<Container>::Shard> &
+ShardedDataStructure<Container>::locate(const Key &k) {
+  if (unlikely(key_to_shards_.empty())) {
+    sync_mapping();
+  }
+  // The shard with the null l_key is always present.
+  auto iter = key_to_shards_.upper_bound(std::optional<Key>(k));
+  return std::prev(iter)->second;
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::flush() {
+  if constexpr (InsertAble<Impl>) {
+    if (!insert_reqs_.empty()) {
+      flush_insert_reqs();
+    }
+  }
+  if constexpr (PushBackAble<Impl>) {
+    if (!push_back_reqs_.empty()) {
+      flush_push_back_reqs();
+    }
+  }
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::flush_insert_reqs() requires
+    InsertAble<Impl> {
+  auto reqs = std::move(insert_reqs_);
+  insert_reqs_.clear();
+
+  while (!reqs.empty()) {
+    std::unordered_map<ProcletID,
+                       std::pair<WeakProclet<Shard>, std::vector<DataEntry>>>
+        batches;
+    for (auto &req : reqs) {
+      auto &shard = locate(Shard::to_key(req));
+      auto &batch = batches[shard.get_id()];
+      batch.first = shard;
+      batch.second.emplace_back(std::move(req));
+    }
+    reqs.clear();
+
+    std::vector<Future<std::vector<DataEntry>>> futures;
+    futures.reserve(batches.size());
+    for (auto &[_, batch] : batches) {
+      futures.emplace_back(batch.first.run_async(&Shard::try_insert_batch,
+                                                 std::move(batch.second)));
+    }
+    for (auto &future : futures) {
+      auto &rejected = future.get();
+      reqs.insert(reqs.end(), std::make_move_iterator(rejected.begin()),
+                  std::make_move_iterator(rejected.end()));
+    }
+    if (unlikely(!reqs.empty())) {
+      sync_mapping();
+    }
+  }
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::flush_push_back_reqs() requires
+    PushBackAble<Impl> {
+  auto reqs = std::move(push_back_reqs_);
+  push_back_reqs_.clear();
+
+  while (!reqs.empty()) {
+    if (unlikely(key_to_shards_.empty())) {
+      sync_mapping();
+    }
+    auto &tail = std::prev(key_to_shards_.end())->second;
+    reqs = tail.run(&Shard::try_push_back_batch, std::move(reqs));
+    if (unlikely(!reqs.empty())) {
+      sync_mapping();
+    }
+  }
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::__insert(DataEntry entry) requires
+    InsertAble<Impl> {
+  insert_reqs_.emplace_back(std::move(entry));
+  if (insert_reqs_.size() >= max_batch_size_) {
+    flush_insert_reqs();
+  }
+}
+
+template <typename Container>
+inline void ShardedDataStructure<Container>::__push_back(Val v) requires
+    PushBackAble<Impl> {
+  push_back_reqs_.emplace_back(std::move(v));
+  if (push_back_reqs_.size() >= max_batch_size_) {
+    flush_push_back_reqs();
+  }
+}
+
+template <typename Container>
+inline bool ShardedDataStructure<Container>::__erase(Key k) requires
+    EraseAble<Impl> {
+  flush();
+  while (true) {
+    auto erased = locate(k).run(&Shard::try_erase, k);
+    if (likely(erased)) {
+      return *erased;
+    }
+    sync_mapping();
+  }
+}
+
+template <typename Container>
+template <typename RetT, typename... S0s, typename... S1s>
+inline RetT ShardedDataStructure<Container>::compute_on(
+    Key k, RetT (*fn)(Impl &, Key, S0s...), S1s &&... states) {
+  flush();
+  while (true) {
+    auto ret = locate(k).__run(&Shard::template try_compute_on<RetT, S0s...>,
+                               k, fn, states...);
+    if (likely(ret)) {
+      return std::move(*ret);
+    }
+    sync_mapping();
+  }
+}
+
+template <typename Container>
+template <typename RetT, typename... S0s, typename... S1s>
+inline std::vector<Future<RetT>>
+ShardedDataStructure<Container>::compute_on_all(RetT (*fn)(Impl &, S0s...),
+                                                S1s &&... states) {
+  flush();
+  sync_mapping();
+  std::vector<Future<RetT>> futures;
+  futures.reserve(key_to_shards_.size());
+  for (auto &[_, shard] : key_to_shards_) {
+    futures.emplace_back(shard.__run_async(
+        &Shard::template compute<RetT, S0s...>, fn, states...));
+  }
+  return futures;
+}
+
+template <typename Container>
+inline std::size_t ShardedDataStructure<Container>::size() {
+  std::size_t size = 0;
+  auto futures =
+      compute_on_all(+[](Impl &impl) -> std::size_t { return impl.size(); });
+  for (auto &future : futures) {
+    size += future.get();
+  }
+  return size;
+}
+
+template <typename Container>
+inline bool ShardedDataStructure<Container>::empty() {
+  return !size();
+}
+
+template <typename Container>
+inline uint32_t ShardedDataStructure<Container>::num_shards() {
+  sync_mapping();
+  return key_to_shards_.size();
+}
+
+template <typename Container>
+template <typename... S0s, typename... S1s>
+inline void ShardedDataStructure<Container>::for_all(
+    void (*fn)(const Key &key, Val &val, S0s...),
+    S1s &&... states) requires HasVal<Impl> {
+  auto futures = compute_on_all(
+      +[](Impl &impl, decltype(fn) fn, S0s... states) {
+        impl.for_all(fn, states...);
+      },
+      fn, std::forward<S1s>(states)...);
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+template <typename Container>
+template <typename... S0s, typename... S1s>
+inline void ShardedDataStructure<Container>::for_all(
+    void (*fn)(const Key &key, S0s...),
+    S1s &&... states) requires(!HasVal<Impl>) {
+  auto futures = compute_on_all(
+      +[](Impl &impl, decltype(fn) fn, S0s... states) {
+        impl.for_all(fn, states...);
+      },
+      fn, std::forward<S1s>(states)...);
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+template <typename Container>
+template <class Archive>
+inline void ShardedDataStructure<Container>::save(Archive &ar) const {
+  ar(mapping_, max_batch_size_);
+}
+
+template <typename Container>
+template <class Archive>
+inline void ShardedDataStructure<Container>::load(Archive &ar) {
+  ar(mapping_, max_batch_size_);
+}
+
+}  // namespace nu
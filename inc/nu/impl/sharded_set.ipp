@@ -0,0 +1,94 @@
+#include <iterator>
+#include <utility>
+
+namespace nu {
+
+template <typename K>
+inline std::size_t SetImpl<K>::size() const {
+  return set_.size();
+}
+
+template <typename K>
+inline bool SetImpl<K>::empty() const {
+  return set_.empty();
+}
+
+template <typename K>
+inline void SetImpl<K>::clear() {
+  set_.clear();
+}
+
+template <typename K>
+inline std::size_t SetImpl<K>::insert(Key k) {
+  set_.emplace(std::move(k));
+  return set_.size();
+}
+
+template <typename K>
+inline bool SetImpl<K>::erase(Key k) {
+  return set_.erase(k);
+}
+
+template <typename K>
+inline bool SetImpl<K>::contains(const Key &k) const {
+  return set_.contains(k);
+}
+
+template <typename K>
+inline void SetImpl<K>::split(Key *mid_k, SetImpl *latter_half) {
+  auto mid_iter = std::next(set_.begin(), set_.size() / 2);
+  *mid_k = *mid_iter;
+  latter_half->set_.clear();
+  while (mid_iter != set_.end()) {
+    latter_half->set_.insert(latter_half->set_.end(), set_.extract(mid_iter++));
+  }
+}
+
+template <typename K>
+inline void SetImpl<K>::merge(SetImpl set) {
+  set_.merge(set.set_);
+}
+
+template <typename K>
+template <typename... S0s, typename... S1s>
+inline void SetImpl<K>::for_all(void (*fn)(const Key &key, S0s...),
+                                S1s &&... states) {
+  for (auto &k : set_) {
+    fn(k, states...);
+  }
+}
+
+template <typename K>
+template <class Archive>
+inline void SetImpl<K>::serialize(Archive &ar) {
+  ar(set_);
+}
+
+template <typename K>
+inline ShardedSet<K>::ShardedSet(uint32_t max_shard_size,
+                                 uint32_t max_batch_size)
+    : Base(max_shard_size, max_batch_size) {}
+
+template <typename K>
+inline void ShardedSet<K>::insert(K k) {
+  Base::__insert(std::move(k));
+}
+
+template <typename K>
+inline bool ShardedSet<K>::erase(K k) {
+  return Base::__erase(std::move(k));
+}
+
+template <typename K>
+inline bool ShardedSet<K>::contains(K k) {
+  return Base::compute_on(
+      std::move(k), +[](SetImpl<K> &impl, K k) { return impl.contains(k); });
+}
+
+template <typename K>
+inline ShardedSet<K> make_sharded_set(uint32_t max_shard_size,
+                                      uint32_t max_batch_size) {
+  return ShardedSet<K>(max_shard_size, max_batch_size);
+}
+
+}  // namespace nu
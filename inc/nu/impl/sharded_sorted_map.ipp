@@ -0,0 +1,100 @@
+#include <iterator>
+#include <utility>
+
+namespace nu {
+
+template <typename K, typename V>
+inline std::size_t SortedMapImpl<K, V>::size() const {
+  return map_.size();
+}
+
+template <typename K, typename V>
+inline bool SortedMapImpl<K, V>::empty() const {
+  return map_.empty();
+}
+
+template <typename K, typename V>
+inline void SortedMapImpl<K, V>::clear() {
+  map_.clear();
+}
+
+template <typename K, typename V>
+inline std::size_t SortedMapImpl<K, V>::insert(Key k, Val v) {
+  map_.insert_or_assign(std::move(k), std::move(v));
+  return map_.size();
+}
+
+template <typename K, typename V>
+inline bool SortedMapImpl<K, V>::erase(Key k) {
+  return map_.erase(k);
+}
+
+template <typename K, typename V>
+inline std::optional<V> SortedMapImpl<K, V>::get(const Key &k) const {
+  auto iter = map_.find(k);
+  if (iter == map_.end()) {
+    return std::nullopt;
+  }
+  return iter->second;
+}
+
+template <typename K, typename V>
+inline void SortedMapImpl<K, V>::split(Key *mid_k, SortedMapImpl *latter_half) {
+  auto mid_iter = std::next(map_.begin(), map_.size() / 2);
+  *mid_k = mid_iter->first;
+  latter_half->map_.clear();
+  while (mid_iter != map_.end()) {
+    latter_half->map_.insert(latter_half->map_.end(), map_.extract(mid_iter++));
+  }
+}
+
+template <typename K, typename V>
+inline void SortedMapImpl<K, V>::merge(SortedMapImpl map) {
+  map_.merge(map.map_);
+}
+
+template <typename K, typename V>
+template <typename... S0s, typename... S1s>
+inline void SortedMapImpl<K, V>::for_all(void (*fn)(const Key &key, Val &val,
+                                                    S0s...),
+                                         S1s &&... states) {
+  for (auto &[k, v] : map_) {
+    fn(k, v, states...);
+  }
+}
+
+template <typename K, typename V>
+template <class Archive>
+inline void SortedMapImpl<K, V>::serialize(Archive &ar) {
+  ar(map_);
+}
+
+template <typename K, typename V>
+inline ShardedSortedMap<K, V>::ShardedSortedMap(uint32_t max_shard_size,
+                                                uint32_t max_batch_size)
+    : Base(max_shard_size, max_batch_size) {}
+
+template <typename K, typename V>
+inline void ShardedSortedMap<K, V>::insert(K k, V v) {
+  Base::__insert(std::make_pair(std::move(k), std::move(v)));
+}
+
+template <typename K, typename V>
+inline bool ShardedSortedMap<K, V>::erase(K k) {
+  return Base::__erase(std::move(k));
+}
+
+template <typename K, typename V>
+inline std::optional<V> ShardedSortedMap<K, V>::find_data(K k) {
+  return Base::compute_on(
+      std::move(k),
+      +[](SortedMapImpl<K, V> &impl, K k) { return impl.get(k); });
+}
+
+template <typename K, typename V>
+inline ShardedSortedMap<K, V> make_sharded_sorted_map(uint32_t max_shard_size,
+                                                      uint32_t max_batch_size) {
+  return ShardedSortedMap<K, V>(max_shard_size, max_batch_size);
+}
+
+}  // namespace nu
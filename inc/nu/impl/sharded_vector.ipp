@@ -0,0 +1,131 @@
+#include <iterator>
+#include <utility>
+
+namespace nu {
+
+template <typename T>
+inline VectorImpl<T>::VectorImpl() : l_key_(0) {}
+
+template <typename T>
+inline std::size_t VectorImpl<T>::size() const {
+  return data_.size();
+}
+
+template <typename T>
+inline bool VectorImpl<T>::empty() const {
+  return data_.empty();
+}
+
+template <typename T>
+inline void VectorImpl<T>::clear() {
+  data_.clear();
+}
+
+template <typename T>
+inline std::size_t VectorImpl<T>::push_back(Val v) {
+  data_.emplace_back(std::move(v));
+  return data_.size();
+}
+
+template <typename T>
+inline void VectorImpl<T>::push_back_batch(std::vector<Val> vs) {
+  if (data_.empty()) {
+    data_ = std::move(vs);
+  } else {
+    data_.insert(data_.end(), std::make_move_iterator(vs.begin()),
+                 std::make_move_iterator(vs.end()));
+  }
+}
+
+template <typename T>
+inline std::optional<T> VectorImpl<T>::get(Key idx) const {
+  if (unlikely(idx < l_key_ || idx - l_key_ >= data_.size())) {
+    return std::nullopt;
+  }
+  return data_[idx - l_key_];
+}
+
+template <typename T>
+inline bool VectorImpl<T>::set(Key idx, Val v) {
+  if (unlikely(idx < l_key_ || idx - l_key_ >= data_.size())) {
+    return false;
+  }
+  data_[idx - l_key_] = std::move(v);
+  return true;
+}
+
+template <typename T>
+inline void VectorImpl<T>::split(Key *mid_k, VectorImpl *latter_half) {
+  *mid_k = l_key_ + data_.size();
+  latter_half->l_key_ = *mid_k;
+  latter_half->data_.clear();
+}
+
+template <typename T>
+inline void VectorImpl<T>::merge(VectorImpl vector) {
+  BUG_ON(vector.l_key_ != l_key_ + data_.size());
+  push_back_batch(std::move(vector.data_));
+}
+
+template <typename T>
+inline typename VectorImpl<T>::Key VectorImpl<T>::rebase(Key new_l_key) {
+  return std::exchange(l_key_, new_l_key);
+}
+
+template <typename T>
+template <typename... S0s, typename... S1s>
+inline void VectorImpl<T>::for_all(void (*fn)(const Key &key, Val &val,
+                                              S0s...),
+                                   S1s &&... states) {
+  for (std::size_t i = 0; i < data_.size(); i++) {
+    fn(l_key_ + i, data_[i], states...);
+  }
+}
+
+template <typename T>
+template <class Archive>
+inline void VectorImpl<T>::serialize(Archive &ar) {
+  ar(l_key_, data_);
+}
+
+template <typename T>
+inline ShardedVector<T>::ShardedVector(uint32_t max_shard_size,
+                                       uint32_t max_batch_size)
+    : Base(max_shard_size, max_batch_size) {}
+
+template <typename T>
+inline void ShardedVector<T>::push_back(T v) {
+  Base::__push_back(std::move(v));
+}
+
+template <typename T>
+inline std::optional<T> ShardedVector<T>::find_data(std::size_t idx) {
+  return Base::compute_on(
+      idx, +[](VectorImpl<T> &impl, std::size_t idx) { return impl.get(idx); });
+}
+
+template <typename T>
+inline T ShardedVector<T>::operator[](std::size_t idx) {
+  auto data = find_data(idx);
+  BUG_ON(!data);
+  return std::move(*data);
+}
+
+template <typename T>
+inline void ShardedVector<T>::set(std::size_t idx, T v) {
+  auto succeeded = Base::compute_on(
+      idx,
+      +[](VectorImpl<T> &impl, std::size_t idx, T v) {
+        return impl.set(idx, std::move(v));
+      },
+      std::move(v));
+  BUG_ON(!succeeded);
+}
+
+template <typename T>
+inline ShardedVector<T> make_sharded_vector(uint32_t max_shard_size,
+                                            uint32_t max_batch_size) {
+  return ShardedVector<T>(max_shard_size, max_batch_size);
+}
+
+}  // namespace nu
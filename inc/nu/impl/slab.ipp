@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
@@ -25,6 +26,7 @@ inline void SlabAllocator::init(SlabId_t slab_id, void *buf, uint64_t len,
   end_ = start_ + len;
   cur_ = const_cast<uint8_t *>(start_);
   global_free_bytes_ = 0;
+  std::fill(std::begin(core_caches_), std::end(core_caches_), nullptr);
 }
 
 inline void *SlabAllocator::allocate(size_t size) {
@@ -274,7 +274,8 @@ bool SyncHashMap<NBuckets, K, V, Hash, KeyEqual, Allocator,
 
   auto allocator = Allocator();
   auto *pair = allocator.allocate(1);
-  new (pair) Pair(k, V1(args)...);
+  new (pair) Pair(std::piecewise_construct, std::forward_as_tuple(k),
+                  std::forward_as_tuple(std::move(args)...));
 
   if (!prev_next) {
     bucket_node->key_hash = key_hash;
@@ -457,6 +458,38 @@ RetT SyncHashMap<NBuckets, K, V, Hash, KeyEqual, Allocator,
   return reduced_val;
 }
 
+template <size_t NBuckets, typename K, typename V, typename Hash,
+          typename KeyEqual, typename Allocator, typename Lock>
+template <typename RetT, typename... A0s, typename... A1s>
+RetT SyncHashMap<NBuckets, K, V, Hash, KeyEqual, Allocator, Lock>::
+    associative_reduce_range(uint64_t *bucket_idx, uint64_t max_num_pairs,
+                             RetT init_val,
+                             void (*reduce_fn)(RetT &, std::pair<const K, V> &,
+                                               A0s...),
+                             A1s &&...args) {
+  // Otherwise no bucket would be covered and *bucket_idx would never advance.
+  BUG_ON(!max_num_pairs);
+  RetT reduced_val(std::move(init_val));
+  uint64_t num_pairs = 0;
+  auto &i = *bucket_idx;
+  for (; i < NBuckets && num_pairs < max_num_pairs; i++) {
+    auto &bucket_head = bucket_heads_[i];
+    auto *bucket_node = &bucket_head.node;
+    auto &lock = bucket_head.lock;
+    if (bucket_head.node.pair) {
+      lock.lock();
+      while (bucket_node && bucket_node->pair) {
+        auto *pair = reinterpret_cast<Pair *>(bucket_node->pair);
+        reduce_fn(reduced_val, *pair, std::forward<A1s>(args)...);
+        num_pairs++;
+        bucket_node = bucket_node->next;
+      }
+      lock.unlock();
+    }
+  }
+  return reduced_val;
+}
+
 template <size_t NBuckets, typename K, typename V, typename Hash,
           typename KeyEqual, typename Allocator, typename Lock>
 inline std::vector<std::pair<K, V>>
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "nu/proclet.hpp"
+#include "nu/utils/future.hpp"
+#include "nu/utils/mutex.hpp"
+#include "nu/utils/sync_hash_map.hpp"
+
+namespace nu {
+
+using MicroProcletID = uint64_t;
+
+template <typename T>
+class MicroProcletPool;
+
+// A regular proclet that hosts many micro-proclets. They share its heap,
+// routing entry and controller segment, and thus migrate together with it.
+template <typename T>
+class MicroProcletHost {
+ public:
+  constexpr static uint64_t kNumBuckets = 32768;
+
+  MicroProcletHost(uint32_t max_num_objs);
+  template <typename... As>
+  std::optional<MicroProcletID> create(As... args);
+  template <typename... As>
+  std::vector<MicroProcletID> create_batch(uint32_t num, As... args);
+  // Returns the ID of the host that held the micro-proclet.
+  ProcletID destroy(MicroProcletID id);
+  void adopt(MicroProcletID id, T obj);
+  void split_to(MicroProcletID id, WeakProclet<MicroProcletHost> dst);
+  template <typename RetT, typename... S0s>
+  RetT invoke(MicroProcletID id, RetT (*fn)(T &, S0s...), S0s... states);
+
+ private:
+  uint32_t max_num_objs_;
+  std::atomic<uint64_t> next_id_;
+  std::atomic<uint32_t> num_objs_;
+  SyncHashMap<kNumBuckets, MicroProcletID, T> objs_;
+  // Micro-proclets that have been split out into their own host.
+  SyncHashMap<kNumBuckets, MicroProcletID, WeakProclet<MicroProcletHost>>
+      forwards_;
+  // Serializes splits against lookups that miss objs_, so that a micro-proclet
+  // is always found either in objs_ or in forwards_.
+  Mutex split_mutex_;
+};
+
+// A lightweight handle to an object living inside a shared host proclet.
+// Creating one costs a single invocation of the host rather than a controller
+// round trip and a dedicated heap segment.
+template <typename T>
+class MicroProclet {
+ public:
+  MicroProclet();
+  operator bool() const;
+  MicroProcletID get_id() const;
+  ProcletID get_host_id() const;
+  template <typename RetT, typename... S0s, typename... S1s>
+  Future<RetT> run_async(RetT (*fn)(T &, S0s...), S1s &&... states);
+  template <typename RetT, typename... S0s, typename... S1s>
+  RetT run(RetT (*fn)(T &, S0s...), S1s &&... states);
+
+  template <class Archive>
+  void serialize(Archive &ar);
+
+ private:
+  WeakProclet<MicroProcletHost<T>> host_;
+  MicroProcletID id_;
+
+  MicroProclet(WeakProclet<MicroProcletHost<T>> host, MicroProcletID id);
+
+  friend class MicroProcletPool<T>;
+};
+
+template <typename T>
+class MicroProcletPool {
+ public:
+  constexpr static uint32_t kDefaultMaxNumObjsPerHost = 1 << 18;
+
+  MicroProcletPool(uint64_t host_capacity = kDefaultProcletHeapSize,
+                   uint32_t max_num_objs_per_host = kDefaultMaxNumObjsPerHost);
+  MicroProcletPool(const MicroProcletPool &) = delete;
+  MicroProcletPool &operator=(const MicroProcletPool &) = delete;
+  template <typename... As>
+  MicroProclet<T> create(As &&... args);
+  template <typename... As>
+  Future<MicroProclet<T>> create_async(As &&... args);
+  // Creates num micro-proclets constructed from the same arguments, packing as
+  // many of them as possible into each host invocation.
+  template <typename... As>
+  std::vector<MicroProclet<T>> create_batch(uint32_t num, As &&... args);
+  void destroy(const MicroProclet<T> &micro_proclet);
+  // Moves the micro-proclet into a dedicated host so that it can be migrated
+  // on its own. The caller must ensure it is quiescent. Stale handles keep
+  // working through a forwarding entry left in the original host.
+  MicroProclet<T> split(const MicroProclet<T> &micro_proclet,
+                        std::optional<NodeIP> ip_hint = std::nullopt);
+
+ private:
+  using Host = MicroProcletHost<T>;
+
+  uint64_t host_capacity_;
+  uint32_t max_num_objs_per_host_;
+  std::vector<Proclet<Host>> hosts_;
+  // Dedicated hosts of split micro-proclets, indexed by their IDs.
+  std::unordered_map<ProcletID, Proclet<Host>> split_hosts_;
+  Mutex mutex_;
+
+  WeakProclet<Host> get_free_host();
+  void handle_full_host(const WeakProclet<Host> &host);
+};
+
+}  // namespace nu
+
+#include "nu/impl/micro_proclet.ipp"
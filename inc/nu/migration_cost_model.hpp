@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include "nu/commons.hpp"
+#include "nu/utils/spin_lock.hpp"
+
+namespace nu {
+
+struct MigrationSample {
+  uint64_t mem_size;
+  uint32_t num_threads;
+  uint64_t time_us;
+};
+
+// Estimates how long migrating a proclet pauses it, as
+//   fixed_us + per_mb_us * mem_mbs + per_thread_us * num_threads.
+// The coefficients are fitted online per destination with exponentially
+// decayed least squares, regularized towards the static priors below so that
+// the model is usable before (and stays sane with few) samples. Estimates
+// average the fits of all destinations seen so far, since the destination is
+// unknown when proclets are ranked.
+class MigrationCostModel {
+ public:
+  constexpr static float kPriorFixedCostUs = 25;
+  constexpr static float kPriorNetBwGbps = 100;
+  constexpr static float kPriorPerMBUs =
+      kOneMB * 8 / (kPriorNetBwGbps * 1000);
+  constexpr static float kPriorPerThreadUs = 0;
+  // The weight of the priors, in number of samples.
+  constexpr static float kPriorWeight = 1;
+  constexpr static float kDecay = 0.98;
+
+  MigrationCostModel();
+  float estimate_us(uint64_t mem_size, uint32_t num_threads) const;
+  void record(NodeIP dest_ip, const MigrationSample &sample);
+
+ private:
+  constexpr static uint32_t kNumFeatures = 3;
+
+  struct Fit {
+    Fit();
+
+    float xtx[kNumFeatures][kNumFeatures];
+    float xty[kNumFeatures];
+    float coeffs[kNumFeatures];
+  };
+
+  std::unordered_map<NodeIP, Fit> fits_;
+  SpinLock spin_;
+  std::atomic<float> fixed_us_;
+  std::atomic<float> per_mb_us_;
+  std::atomic<float> per_thread_us_;
+
+  static void solve(Fit *fit);
+};
+
+}  // namespace nu
+
+#include "nu/impl/migration_cost_model.ipp"
@@ -5,6 +5,7 @@
 #include <memory>
 #include <set>
 #include <span>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
@@ -17,8 +18,11 @@ extern "C" {
 #include <sync.h>
 
 #include "nu/ctrl_client.hpp"
+#include "nu/migration_cost_model.hpp"
 #include "nu/rpc_server.hpp"
 #include "nu/utils/archive_pool.hpp"
+#include "nu/utils/lz4.hpp"
+#include "nu/utils/md5.hpp"
 #include "nu/utils/rpc.hpp"
 #include "nu/utils/slab.hpp"
 
@@ -38,13 +42,19 @@ enum MigratorTCPOp_t {
   kDisablePoll,
   kRegisterCallBack,
   kDeregisterCallBack,
+  kCopyEncodedProclet,
 };
 
 struct RPCReqForward {
   RPCReqType rpc_type = kForward;
-  RPCReturnCode rc;
   RPCReturner returner;
   ArchivePool<>::IASStream *gc_ia_sstream;
+};
+
+struct RPCReqDirectReturn {
+  RPCReqType rpc_type = kDirectReturn;
+  RPCReturnCode rc;
+  std::size_t completion_data;
   uint64_t payload_len;
   uint8_t payload[0];
 };
@@ -58,6 +68,40 @@ struct RPCReqMigrateThreadAndRetVal {
   uint8_t payload[0];
 } __attribute__((packed));
 
+// Heap stripes are encoded on the wire in chunks of up to kEncodedChunkSize
+// bytes, each aligned to its natural boundary (except for the stripe ends).
+// Elided zero pages are omitted from the payload; the remaining bytes are
+// either sent as is or LZ4-compressed.
+struct EncodedChunkHeader {
+  uint32_t payload_len;
+  uint16_t zero_pages;
+  bool compressed;
+} __attribute__((packed));
+
+// Per-sender scratch space for encoding heap stripes.
+struct StripeEncoder {
+  StripeEncoder();
+
+  LZ4 lz4;
+  std::unique_ptr<std::byte[]> gather_buf;
+  std::unique_ptr<std::byte[]> compression_buf;
+};
+
+// Leads a proclet snapshot file. The heap follows at kSnapshotHeapOffset and is
+// laid out as in memory so that it can be mapped back in place. All-zero pages
+// are left as file holes.
+struct ProcletSnapshotHeader {
+  constexpr static uint64_t kMagic = 0x746f687370616e73;  // "snapshot"
+
+  uint64_t magic;
+  MD5Val md5;
+  ProcletID id;
+  uint64_t capacity;
+  uint64_t heap_len;
+  int64_t logical_tsc;
+  bool migratable;
+};
+
 struct ProcletMigrationTask {
   ProcletHeader *header;
   uint64_t capacity;
@@ -107,18 +151,45 @@ class Migrator {
   constexpr static uint32_t kPort = 8002;
   constexpr static float kMigrationThrottleGBs = 0;
   constexpr static uint32_t kMigrationDelayUs = 0;
+  constexpr static bool kEnableCompression = false;
+  constexpr static bool kEnableZeroPageElision = true;
+  constexpr static bool kEncodeStripes =
+      kEnableCompression || kEnableZeroPageElision;
+  constexpr static uint64_t kEncodedChunkSize = 16 * kPageSize;
+  constexpr static uint64_t kMinMadviseZeroLen = 64 * kPageSize;
+
+  static_assert(kEncodedChunkSize <= LZ4::kMaxInputSize);
+  static_assert(kEncodedChunkSize / kPageSize <=
+                sizeof(EncodedChunkHeader::zero_pages) * 8);
 
   static_assert(kTransmitProcletNumThreads > 1);
 
+  constexpr static uint64_t kSnapshotHeapOffset = kPageSize;
+  static_assert(sizeof(ProcletSnapshotHeader) <= kSnapshotHeapOffset);
+  // Spill cold proclets to local files when there is no migration destination
+  // under memory pressure.
+  constexpr static bool kEnableSpilling = false;
+  constexpr static float kSpillMaxCPULoad = 0.05;
+  constexpr static char kSpillDir[] = "/tmp";
+
   Migrator();
   ~Migrator();
   uint32_t migrate(
       const std::vector<std::pair<ProcletMigrationTask, Resource>> &tasks);
   void reserve_conns(uint32_t dest_server_ip);
-  void forward_to_original_server(RPCReturnCode rc, RPCReturner *returner,
-                                  uint64_t payload_len, const void *payload,
-                                  ArchivePool<>::IASStream *ia_sstream);
-  void forward_to_client(RPCReqForward &req);
+  void return_from_migrated_thread(RPCReturnCode rc, RPCReturner *returner,
+                                   uint64_t payload_len, const void *payload,
+                                   ArchivePool<>::IASStream *ia_sstream);
+  void direct_return(RPCReqDirectReturn &req);
+  void finish_forwarded_call(RPCReqForward &req);
+  static void transmit_encoded(rt::TcpConn *c, std::span<const iovec> task,
+                               StripeEncoder *encoder);
+  static bool save_proclet_snapshot(ProcletHeader *proclet_header,
+                                    const std::string &path);
+  static ProcletID restore_proclet_snapshot(const std::string &path,
+                                            bool pinned);
+  void unspill_proclet(ProcletHeader *proclet_header);
+  const MigrationCostModel &cost_model() const;
   template <typename RetT>
   static MigrationGuard migrate_thread_and_ret_val(
       RPCReturnBuffer &&ret_val_buf, ProcletID dest_id, RetT *dest_ret_val_ptr,
@@ -135,19 +206,22 @@ class Migrator {
   std::set<rt::TcpConn *> callback_conns_;
   bool callback_triggered_;
   std::unordered_set<uint32_t> delayed_srv_ips_;
+  StripeEncoder encoder_;
+  MigrationCostModel cost_model_;
   rt::Thread th_;
 
   void run_background_loop();
-  void handle_copy_proclet(rt::TcpConn *c);
+  void handle_copy_proclet(rt::TcpConn *c, bool encoded);
+  void load_encoded(rt::TcpConn *c, std::byte *dest, uint64_t len);
   void handle_load(rt::TcpConn *c);
   void handle_register_callback(rt::TcpConn *c);
   void handle_deregister_callback(rt::TcpConn *c);
   VAddrRange load_stack_cluster_mmap_task(rt::TcpConn *c);
-  void transmit(rt::TcpConn *c, ProcletHeader *proclet_header,
-                struct list_head *head);
+  MigrationSample transmit(rt::TcpConn *c, ProcletHeader *proclet_header,
+                           struct list_head *head);
   void update_proclet_location(rt::TcpConn *c, ProcletHeader *proclet_header);
   void transmit_stack_cluster_mmap_task(rt::TcpConn *c);
-  void transmit_proclet(rt::TcpConn *c, ProcletHeader *proclet_header);
+  uint64_t transmit_proclet(rt::TcpConn *c, ProcletHeader *proclet_header);
   void transmit_proclet_migration_tasks(
       rt::TcpConn *c, bool has_mem_pressure,
       const std::vector<ProcletMigrationTask> &tasks);
@@ -177,6 +251,12 @@ class Migrator {
                      const std::vector<ProcletMigrationTask> &tasks);
   void pause_migrating_threads(ProcletHeader *proclet_header);
   void post_migration_cleanup(ProcletHeader *proclet_header);
+  static void map_proclet_snapshot(
+      int fd, const ProcletSnapshotHeader &snapshot_header, bool migratable);
+  static std::string get_spill_path(ProcletHeader *proclet_header);
+  bool spill_proclet(ProcletHeader *proclet_header);
+  uint32_t spill(
+      std::span<const std::pair<ProcletMigrationTask, Resource>> tasks);
   template <typename RetT>
   static void snapshot_thread_and_ret_val(std::unique_ptr<std::byte[]> *req_buf,
                                           uint64_t *req_buf_len,
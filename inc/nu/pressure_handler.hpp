@@ -1,8 +1,10 @@
+#pragma once
+
 #include <atomic>
 #include <climits>
 #include <cstddef>
 #include <memory>
-#include <set>
+#include <unordered_set>
 
 extern "C" {
 #include <runtime/pressure.h>
@@ -10,6 +12,7 @@ extern "C" {
 #include <net.h>
 
 #include "nu/migrator.hpp"
+#include "nu/utils/spin_lock.hpp"
 
 namespace nu {
 
@@ -18,6 +21,8 @@ using ResourcePressureInfo = struct resource_pressure_info;
 struct AuxHandlerState {
   MigratorConn conn;
   std::vector<iovec> tcp_write_task;
+  StripeEncoder encoder;
+  bool encode = false;
   bool pause = false;
   bool task_pending = false;
   bool done = false;
@@ -27,8 +32,6 @@ struct Utility {
   Utility();
   Utility(ProcletHeader *proclet_header, uint64_t mem_size, float cpu_load);
 
-  constexpr static uint32_t kFixedCostUs = 25;
-  constexpr static uint32_t kNetBwGbps = 100;
   ProcletHeader *header;
   float mem_pressure_util;
   float cpu_pressure_util;
@@ -38,7 +41,15 @@ class PressureHandler {
  public:
   constexpr static uint32_t kNumAuxHandlers =
       Migrator::kTransmitProcletNumThreads - 1;
-  constexpr static uint32_t kSortedProcletsUpdateIntervalMs = 200;
+  // Candidates are bucketed by the binary exponents of their utilities, i.e.,
+  // bucket i holds utilities within [2^(i + kMinUtilExp), 2^(i + kMinUtilExp +
+  // 1)). The order within a bucket is arbitrary.
+  constexpr static uint32_t kNumUtilBuckets = 64;
+  constexpr static int32_t kMinUtilExp = -40;
+  // Invoked proclets re-bucket themselves at most once per interval, while
+  // idle ones are caught up by the periodical refresh.
+  constexpr static uint32_t kCandidateUpdateIntervalUs = 1000;
+  constexpr static uint32_t kCandidatesRefreshIntervalMs = 200;
   constexpr static uint32_t kUpdateBudget = 200;
   constexpr static uint32_t kHandlerSleepUs = 100;
   constexpr static uint32_t kMinNumProcletsOnCPUPressure = 32;
@@ -48,7 +59,8 @@ class PressureHandler {
   void wait_aux_tasks();
   void update_aux_handler_state(uint32_t handler_id, MigratorConn &&conn);
   void dispatch_aux_tcp_task(uint32_t handler_id,
-                             std::vector<iovec> &&tcp_write_task);
+                             std::vector<iovec> &&tcp_write_task,
+                             bool encode = false);
   void dispatch_aux_pause_task(uint32_t handler_id);
   void mock_set_pressure();
   void mock_clear_pressure();
@@ -57,22 +69,16 @@ class PressureHandler {
   bool has_pressure();
   bool has_real_pressure();
   void set_handled();
+  void add_candidate(ProcletHeader *header);
+  void remove_candidate(ProcletHeader *header);
+  void update_candidate(ProcletHeader *header);
 
  private:
-  struct CmpMemUtil {
-    bool operator()(const Utility &x, const Utility &y) const {
-      return x.mem_pressure_util > y.mem_pressure_util;
-    }
-  };
-  struct CmpCpuUtil {
-    bool operator()(const Utility &x, const Utility &y) const {
-      return x.cpu_pressure_util > y.cpu_pressure_util;
-    }
-  };
-  std::shared_ptr<std::multiset<Utility, CmpMemUtil>>
-      mem_pressure_sorted_proclets_;
-  std::shared_ptr<std::multiset<Utility, CmpCpuUtil>>
-      cpu_pressure_sorted_proclets_;
+  using UtilBuckets = std::unordered_set<ProcletHeader *>[kNumUtilBuckets];
+
+  UtilBuckets mem_util_buckets_;
+  UtilBuckets cpu_util_buckets_;
+  SpinLock candidates_spin_;
   rt::Thread update_th_;
   std::atomic<int> active_handlers_;
   AuxHandlerState aux_handler_states_[kNumAuxHandlers];
@@ -81,7 +87,9 @@ class PressureHandler {
 
   std::vector<std::pair<ProcletMigrationTask, Resource>> pick_tasks(
       uint32_t min_num_proclets, uint32_t min_mem_mbs);
-  void update_sorted_proclets();
+  static int8_t to_util_bucket(float util);
+  void rebucket_candidate(ProcletHeader *header, const Utility &u);
+  void refresh_candidates();
   void register_handlers();
   void pause_aux_handlers();
   void __main_handler();
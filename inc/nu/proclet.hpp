@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <optional>
 #include <functional>
+#include <string>
 
 #include "nu/commons.hpp"
 #include "nu/type_traits.hpp"
@@ -59,6 +61,10 @@ class Proclet {
   std::optional<Future<void>> reset_async();
   WeakProclet<T> get_weak() const;
   bool is_local() const;
+  // Persists the proclet into a file on its hosting node. The caller must
+  // ensure it is quiescent, i.e., no other threads are running or blocked in
+  // it. Returns false on failure.
+  bool snapshot(const std::string &path);
 
   template <class Archive>
   void save(Archive &ar) const;
@@ -69,11 +75,22 @@ class Proclet {
 
  private:
   ProcletID id_;
+  // The share of the proclet's reference count held by this handle. Zero for
+  // weak handles.
+  mutable std::atomic<uint32_t> weight_;
 
   template <typename U>
   friend class WeakProclet;
   template <typename U>
   friend class RemPtr;
+  template <typename U>
+  friend class MicroProclet;
+  template <typename U>
+  friend class MicroProcletHost;
+  template <typename U>
+  friend class ReplicatedProclet;
+  template <typename U>
+  friend class ShardedDataStructure;
   template <typename K, typename V, typename Hash, typename KeyEqual,
             uint64_t NumBuckets>
   friend class DistributedHashTable;
@@ -82,7 +99,8 @@ class Proclet {
       int argc, char **argv,
       std::function<void(int argc, char **argv)> main_func);
 
-  std::optional<Future<void>> update_ref_cnt(ProcletID id, int delta);
+  std::optional<Future<void>> update_ref_cnt(ProcletID id, int64_t delta);
+  uint32_t split_weight() const;
   template <typename... S1s>
   static void invoke_remote(MigrationGuard &&caller_guard, ProcletID id,
                             S1s &&...states);
@@ -92,6 +110,7 @@ class Proclet {
   template <typename... As>
   static Proclet __create(bool pinned, uint64_t capacity, NodeIP ip_hint,
                           As &&... args);
+  static Proclet __restore(const std::string &path, bool pinned);
   template <bool MigrEn = true, bool CPUMon = true, bool CPUSamp = true,
             typename RetT, typename... S0s, typename... S1s>
   Future<RetT> __run_async(RetT (*fn)(T &, S0s...), S1s &&... states);
@@ -119,6 +138,8 @@ class Proclet {
   template <typename U>
   friend Future<Proclet<U>> make_proclet_async(bool, std::optional<uint64_t>,
                                                std::optional<NodeIP>);
+  template <typename U>
+  friend Proclet<U> restore_proclet(const std::string &, bool);
 };
 
 template <typename T>
@@ -162,6 +183,11 @@ template <typename T>
 Future<Proclet<T>> make_proclet_async(
     bool pinned = false, std::optional<uint64_t> capacity = std::nullopt,
     std::optional<uint32_t> ip_hint = std::nullopt);
+// Restores a proclet from a local snapshot file into its original address
+// range on this node. Returns a null proclet if the snapshot is invalid or the
+// range is already taken.
+template <typename T>
+Proclet<T> restore_proclet(const std::string &path, bool pinned = false);
 
 }  // namespace nu
 
@@ -7,6 +7,7 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 extern "C" {
@@ -34,6 +35,7 @@ enum ProcletStatus {
   kDepopulating,
   kCleaning,
   kMigrating,
+  kSpilled,
   kPresent,
   kDestructing,
 };
@@ -42,6 +44,9 @@ enum ProcletStatus {
 // even if the proclets are not present locally.
 extern uint8_t proclet_statuses[kMaxNumProclets];
 extern SpinLock proclet_migration_spin[kMaxNumProclets];
+// Where the proclets have been migrated to, so that stale callers can be
+// redirected without consulting the controller.
+extern NodeIP proclet_tombstones[kMaxNumProclets];
 
 struct ProcletHeader {
   ~ProcletHeader() = default;
@@ -68,14 +73,23 @@ struct ProcletHeader {
   // Logical timer.
   Time time;
 
+  // Position in the pressure handler's migration-candidate index.
+  constexpr static int8_t kNoUtilBucket = -1;
+  uint64_t util_update_tsc;
+  int8_t mem_util_bucket;
+  int8_t cpu_util_bucket;
+
   //--- Fields below will be automatically copied during migration. ---/
   uint8_t copy_start[0];
 
   // For disabling migration.
   RCULock rcu_lock;
 
-  // Ref cnt related.
-  int ref_cnt;
+  // Ref cnt related, i.e., the sum of the weights held by all handles.
+  int64_t ref_cnt;
+
+  // Bumped by every RemPtr::run() into the heap, validates cached reads.
+  std::atomic<uint64_t> rem_ptr_version;
 
   // Heap mem allocator. Must be the last field.
   Counter slab_ref_cnt;
@@ -88,11 +102,19 @@ struct ProcletHeader {
   uint8_t &status();
   uint8_t status() const;
   SpinLock &migration_spin();
+  NodeIP &tombstone();
   VAddrRange range() const;
 };
 
 class ProcletManager {
  public:
+  // Backs proclet heaps with transparent huge pages and populates and
+  // releases them in whole huge pages.
+  constexpr static bool kEnableHugePages = false;
+  // The granularity of populating and releasing proclet heaps.
+  constexpr static uint64_t kHeapPageSize =
+      kEnableHugePages ? kHugePageSize : kPageSize;
+
   ProcletManager();
 
   static void setup(void *proclet_base, uint64_t capacity, bool migratable,
@@ -100,6 +122,11 @@ class ProcletManager {
   void cleanup(void *proclet_base, bool for_migration);
   static void madvise_populate(void *proclet_base, uint64_t populate_len);
   static void depopulate(void *proclet_base, uint64_t size, bool defer);
+  // Rounds a heap size up to whole kHeapPageSize pages, without going beyond
+  // the heap's capacity.
+  static uint64_t round_to_heap_pages(uint64_t size, uint64_t capacity);
+  static void bind_to_local_socket(void *addr, uint64_t len);
+  static void enable_huge_pages(void *addr, uint64_t len);
   static void wait_until(ProcletHeader *proclet_header, ProcletStatus status);
   void insert(void *proclet_base);
   bool remove_for_migration(void *proclet_base);
@@ -107,10 +134,9 @@ class ProcletManager {
   std::vector<void *> get_all_proclets();
   uint64_t get_mem_usage();
   uint32_t get_num_present_proclets();
-  template <typename RetT>
-  std::optional<RetT> get_proclet_info(
-      const ProcletHeader *header,
-      std::function<RetT(const ProcletHeader *)> f);
+  template <typename F>
+  std::optional<std::invoke_result_t<F, const ProcletHeader *>>
+  get_proclet_info(const ProcletHeader *header, F &&f);
 
  private:
   std::vector<void *> present_proclets_;
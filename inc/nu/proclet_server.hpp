@@ -3,12 +3,17 @@
 #include <cstdint>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 extern "C" {
 #include <runtime/net.h>
 }
 #include <sync.h>
 
+#include "nu/cereal.hpp"
+#include "nu/type_traits.hpp"
 #include "nu/utils/archive_pool.hpp"
 #include "nu/utils/counter.hpp"
 #include "nu/utils/rpc.hpp"
@@ -18,8 +23,18 @@ namespace nu {
 
 struct ProcletHeader;
 
+// Contiguous arguments that are sent in place, rather than being serialized,
+// once they reach ProcletServer::kMinBulkArgSize bytes.
+template <typename T>
+concept BulkArg = (is_specialization_of_v<T, std::vector> &&
+                   !std::is_same_v<typename T::value_type, bool> &&
+                   cereal::is_memcpy_safe<typename T::value_type>()) ||
+                  std::is_same_v<T, std::string>;
+
 class ProcletServer {
  public:
+  constexpr static uint64_t kMinBulkArgSize = 16 << 10;
+
   ProcletServer();
   ~ProcletServer();
   netaddr get_addr() const;
@@ -29,7 +44,8 @@ class ProcletServer {
   template <typename Cls>
   static void update_ref_cnt_locally(MigrationGuard *callee_guard,
                                      ProcletHeader *caller_header,
-                                     ProcletHeader *callee_header, int delta);
+                                     ProcletHeader *callee_header,
+                                     int64_t delta);
   template <typename Cls, typename... As>
   static void construct_proclet(ArchivePool<>::IASStream *ia_sstream,
                                 RPCReturner *returner);
@@ -50,6 +66,10 @@ class ProcletServer {
                                   ProcletHeader *caller_header,
                                   ProcletHeader *callee_header, FnPtr fn_ptr,
                                   std::tuple<Ss...> *states);
+  template <typename S>
+  static void serialize_arg(ArchivePool<>::OASStream *oa_sstream, S &&s);
+  template <typename S>
+  static void deserialize_arg(ArchivePool<>::IASStream *ia_sstream, S *s);
 
  private:
   using GenericHandler = void (*)(ArchivePool<>::IASStream *ia_sstream,
@@ -71,7 +91,7 @@ class ProcletServer {
   template <typename Cls>
   static void __update_ref_cnt(MigrationGuard *callee_guard, Cls *obj,
                                ArchivePool<>::IASStream *ia_sstream,
-                               RPCReturner returner, int delta,
+                               RPCReturner returner, int64_t delta,
                                bool *destructed);
   template <bool MigrEn, bool CPUMon, bool CPUSamp, typename Cls, typename RetT,
             typename FnPtr, typename... S1s>
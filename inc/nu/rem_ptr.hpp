@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 #include "nu/proclet.hpp"
@@ -17,6 +18,9 @@ class RemPtr {
   RemPtr &operator=(RemPtr &&) noexcept;
   operator bool() const;
   T operator*();
+  // Like operator*, but served by the node-local RemPtrCache. The returned
+  // value may be up to lease_us stale; a zero lease revalidates every read.
+  T read_cached(uint64_t lease_us = 0);
   T *get();
   template <typename RetT, typename... S0s, typename... S1s>
   Future<RetT> run_async(RetT (*fn)(T &, S0s...), S1s &&... states);
@@ -35,6 +39,8 @@ class RemPtr {
   T *raw_ptr_ = nullptr;
 
   RemPtr(T *raw_ptr);
+  RemPtr(WeakProclet<ErasedType> proclet, T *raw_ptr);
+  void invalidate_cached();
 
  private:
   friend class DistributedMemPool;
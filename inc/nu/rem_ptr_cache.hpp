@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include "nu/commons.hpp"
+#include "nu/utils/spin_lock.hpp"
+
+namespace nu {
+
+// A bounded LRU cache of the values read through RemPtr<T>::read_cached(),
+// shared by all proclets of the node. Each entry remembers the version of the
+// owner heap it was read at, which is bumped by every RemPtr::run() into the
+// heap, and a lease. Within the lease the entry is served without contacting
+// the owner; afterwards it is revalidated against the owner's version. The
+// entries live in the runtime slab so that they survive the migration of the
+// proclets reading them.
+template <typename T>
+class RemPtrCache {
+ public:
+  constexpr static uint32_t kCapacity = 4096;
+
+  struct Entry {
+    T val;
+    uint64_t version;
+    uint64_t expiry_us;
+  };
+
+  static RemPtrCache *get();
+  static RemPtrCache *get_if_exists();
+  std::optional<Entry> lookup(ProcletID id, const T *raw_ptr);
+  void update(ProcletID id, const T *raw_ptr, const T &val, uint64_t version,
+              uint64_t expiry_us);
+  void renew(ProcletID id, const T *raw_ptr, uint64_t expiry_us);
+  void invalidate(ProcletID id, const T *raw_ptr);
+
+ private:
+  using Key = std::pair<ProcletID, const T *>;
+  struct KeyHasher {
+    std::size_t operator()(const Key &k) const;
+  };
+  using LRUList = std::list<std::pair<Key, Entry>>;
+
+  static std::atomic<RemPtrCache *> instance_;
+  LRUList lru_;
+  std::unordered_map<Key, typename LRUList::iterator, KeyHasher> index_;
+  SpinLock spin_;
+};
+
+}  // namespace nu
+
+#include "nu/impl/rem_ptr_cache.ipp"
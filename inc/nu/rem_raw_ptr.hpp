@@ -15,6 +15,9 @@ class RemRawPtr : public RemPtr<T> {
   RemRawPtr &operator=(RemRawPtr &&);
 
  private:
+  RemRawPtr(WeakProclet<ErasedType> proclet, T *raw_ptr);
+
+  friend class DistributedMemPool;
   template <typename U, typename... Args>
   friend RemRawPtr<U> make_rem_raw(Args &&... args);
 };
@@ -1,14 +1,26 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 #include "nu/rem_ptr.hpp"
 
 namespace nu {
 
+// Lives next to the object and holds the shared ownership on behalf of all
+// RemSharedPtr copies, each of which owns a share of its weight.
+template <typename T>
+struct RemSharedPtrAnchor {
+  std::shared_ptr<T> shared_ptr;
+  std::atomic<int64_t> weight;
+};
+
 template <typename T>
 class RemSharedPtr : public RemPtr<T> {
  public:
+  constexpr static uint32_t kInitialWeight = 1 << 16;
+
   RemSharedPtr() noexcept;
   RemSharedPtr(std::shared_ptr<T> &&shared_ptr) noexcept;
   ~RemSharedPtr() noexcept;
@@ -27,9 +39,13 @@ class RemSharedPtr : public RemPtr<T> {
   void load(Archive &ar);
 
  private:
-  std::shared_ptr<T> *shared_ptr_ = nullptr;
+  using Anchor = RemSharedPtrAnchor<T>;
+
+  Anchor *anchor_ = nullptr;
+  mutable std::atomic<uint32_t> weight_ = 0;
 
-  RemSharedPtr(std::shared_ptr<T> *shared_ptr);
+  RemSharedPtr(Anchor *anchor);
+  uint32_t split_weight() const;
 
   template <typename U, typename... Args>
   friend RemSharedPtr<U> make_rem_shared(Args &&... args);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "nu/proclet.hpp"
+#include "nu/utils/mutex.hpp"
+#include "nu/utils/read_skewed_lock.hpp"
+
+namespace nu {
+
+// The object held by the primary and by each of its read-only replicas.
+template <typename T>
+struct ReplicaState {
+  T obj;
+  uint64_t version;
+  ReadSkewedLock lock;
+  // Only populated at the primary, which owns the replicas.
+  std::vector<Proclet<ReplicaState>> replicas;
+  Mutex replicas_mutex;
+
+  template <typename... As>
+  ReplicaState(uint64_t version, As... args);
+  template <typename RetT, typename... S0s>
+  RetT read(RetT (*fn)(const T &, S0s...), S0s... states);
+  template <typename RetT, typename... S0s>
+  RetT write(RetT (*fn)(T &, S0s...), S0s... states);
+  void refresh(T new_obj, uint64_t new_version);
+  std::vector<WeakProclet<ReplicaState>> add_replica(NodeIP ip_hint);
+  std::vector<WeakProclet<ReplicaState>> get_replicas();
+};
+
+// A proclet with read-only replicas on other nodes. Reads, i.e., functions
+// taking a const T & or const methods, are served by a local copy if there is
+// one and otherwise spread across all copies. Writes go to the primary, which
+// refreshes every replica before returning, so that the write is visible to
+// all subsequent reads. T must be copyable and serializable.
+template <typename T>
+class ReplicatedProclet {
+ public:
+  ReplicatedProclet();
+  operator bool() const;
+  ProcletID get_id() const;
+  uint32_t get_num_replicas() const;
+  void replicate(NodeIP ip_hint = 0);
+  template <typename RetT, typename... S0s, typename... S1s>
+  RetT run(RetT (*fn)(const T &, S0s...), S1s &&... states);
+  template <typename RetT, typename... A0s, typename... A1s>
+  RetT run(RetT (T::*md)(A0s...) const, A1s &&... args);
+  template <typename RetT, typename... S0s, typename... S1s>
+  RetT run(RetT (*fn)(T &, S0s...), S1s &&... states);
+  template <typename RetT, typename... A0s, typename... A1s>
+  RetT run(RetT (T::*md)(A0s...), A1s &&... args);
+  // Updates the cached replica set with the one maintained by the primary.
+  void refresh_replicas();
+
+  template <class Archive>
+  void serialize(Archive &ar);
+
+ private:
+  using State = ReplicaState<T>;
+
+  Proclet<State> primary_;
+  std::vector<WeakProclet<State>> replicas_;
+
+  ReplicatedProclet(Proclet<State> &&primary);
+  Proclet<State> &pick_read_target();
+
+  template <typename U, typename... As>
+  friend ReplicatedProclet<U> make_replicated_proclet(uint32_t,
+                                                      std::tuple<As...>);
+};
+
+template <typename T, typename... As>
+ReplicatedProclet<T> make_replicated_proclet(uint32_t num_replicas,
+                                             std::tuple<As...> args_tuple = {});
+
+}  // namespace nu
+
+#include "nu/impl/replicated_proclet.ipp"
@@ -2,6 +2,7 @@
 
 #include <limits>
 #include <memory>
+#include <span>
 #include <unordered_map>
 #include <utility>
 
@@ -23,7 +24,12 @@ class RPCClientMgr {
   NodeIP get_ip_by_proclet_id(ProcletID proclet_id);
   void remove_by_ip(NodeIP ip);
   void update_cache(ProcletID proclet_id, NodeIP ip);
+  void update_cache(std::span<const ProcletLocation> locations);
   void invalidate_cache(ProcletID proclet_id, RPCClient *old_client);
+  // Follows the new location carried by a kErrWrongClient response if any,
+  // otherwise falls back to resolving it through the controller.
+  void handle_wrong_client(ProcletID proclet_id, RPCClient *old_client,
+                           const RPCReturnBuffer &return_buf);
 
  private:
   union NodeInfo {  // Supports atomic assignment.
@@ -12,6 +12,7 @@ enum RPCReqEnum {
   // Migrator
   kReserveConns,
   kForward,
+  kDirectReturn,
   kMigrateThreadAndRetVal,
   // Controller
   kRegisterNode,
@@ -24,6 +25,7 @@ enum RPCReqEnum {
   kUpdateLocation,
   kReportFreeResource,
   kDestroyLP,
+  kPushLocations,
   // Proclet server,
   kProcletCall,
   kGCStack,
@@ -104,7 +104,8 @@ class Runtime {
   void send_rpc_resp_ok(ArchivePool<>::OASStream *oa_sstream,
                         ArchivePool<>::IASStream *ia_sstream,
                         RPCReturner *returner);
-  void send_rpc_resp_wrong_client(RPCReturner *returner);
+  void send_rpc_resp_wrong_client(ProcletHeader *proclet_header,
+                                  RPCReturner *returner);
   void shutdown(RPCReturner *returner);
 
  private:
@@ -132,6 +133,7 @@ class Runtime {
                                        A1s &&... args);
   std::optional<MigrationGuard> __reattach_and_disable_migration(
       ProcletHeader *proclet_header);
+  void unspill(ProcletHeader *proclet_header);
   void destroy();
   void destroy_base();
 };
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "nu/container.hpp"
+#include "nu/proclet.hpp"
+#include "nu/utils/future.hpp"
+#include "nu/utils/mutex.hpp"
+#include "nu/utils/read_skewed_lock.hpp"
+
+namespace nu {
+
+template <GeneralContainerBased Container>
+class ShardingMapping;
+
+// A proclet holding the entries of a sharded data structure whose keys fall
+// into [l_key, r_key). A null l_key (r_key) stands for negative (positive)
+// infinity. Requests for keys that the shard does not own (anymore) are
+// rejected, so that the caller can refresh its mapping and retry.
+template <GeneralContainerBased Container>
+class GeneralShard {
+ public:
+  using Key = Container::Key;
+  using Val = Container::Val;
+  using DataEntry = Container::DataEntry;
+  using Impl = Container::Implementation;
+  using Mapping = ShardingMapping<Container>;
+  // A shard whose size drops below max_shard_size / kMergeRatio tries to
+  // absorb its successor.
+  constexpr static uint32_t kMergeRatio = 4;
+
+  GeneralShard(WeakProclet<Mapping> mapping, uint32_t max_shard_size,
+               std::optional<Key> l_key, std::optional<Key> r_key,
+               Container container);
+  static const Key &to_key(const DataEntry &entry);
+  // Returns the entries that were not inserted.
+  std::vector<DataEntry> try_insert_batch(
+      std::vector<DataEntry> reqs) requires InsertAble<Impl>;
+  // Returns the values that were not pushed back.
+  std::vector<Val> try_push_back_batch(
+      std::vector<Val> reqs) requires PushBackAble<Impl>;
+  std::optional<bool> try_erase(Key k) requires EraseAble<Impl>;
+  template <typename RetT, typename... S0s>
+  std::optional<RetT> try_compute_on(Key k, RetT (*fn)(Impl &, Key, S0s...),
+                                     S0s... states);
+  template <typename RetT, typename... S0s>
+  RetT compute(RetT (*fn)(Impl &, S0s...), S0s... states);
+  // Hands over all entries and the r_key to the predecessor if the shard
+  // still starts at l_key and holds no more than max_size entries.
+  std::optional<std::pair<std::optional<Key>, Container>> try_drain(
+      Key l_key, std::size_t max_size);
+
+ private:
+  WeakProclet<Mapping> mapping_;
+  uint32_t max_shard_size_;
+  std::optional<Key> l_key_;
+  std::optional<Key> r_key_;
+  bool drained_;
+  Container container_;
+  ReadSkewedLock lock_;
+
+  bool owns(const Key &k) const;
+  void split(std::size_t num_incoming);
+  void try_merge();
+};
+
+// Range index of all shards, kept in its own proclet.
+template <GeneralContainerBased Container>
+class ShardingMapping {
+ public:
+  using Key = Container::Key;
+  using Shard = GeneralShard<Container>;
+  using ShardList =
+      std::vector<std::pair<std::optional<Key>, WeakProclet<Shard>>>;
+  // The version of the mapping and its shards.
+  using Snapshot = std::pair<uint64_t, ShardList>;
+
+  ShardingMapping();
+  // Takes a snapshot, releasing the one at released_version, if any. The
+  // shards of a snapshot stay alive until it is released.
+  Snapshot get_all_shards(std::optional<uint64_t> released_version);
+  void release_snapshot(uint64_t version);
+  std::optional<WeakProclet<Shard>> get_shard(Key l_key);
+  void add_shard(std::optional<Key> l_key, Proclet<Shard> shard);
+  void retire_shard(Key l_key);
+
+ private:
+  std::map<std::optional<Key>, Proclet<Shard>> mapping_;
+  uint64_t version_;
+  // Version -> number of clients holding a snapshot taken at it.
+  std::map<uint64_t, uint32_t> snapshot_refs_;
+  // Merged shards and the versions they were retired at. They are kept alive
+  // while older snapshots are held, so that clients with stale mappings are
+  // rejected rather than directed to a freed proclet.
+  std::deque<std::pair<uint64_t, Proclet<Shard>>> retired_shards_;
+  Mutex mutex_;
+
+  void __release_snapshot(uint64_t version);
+  std::vector<Proclet<Shard>> pop_unreachable_shards();
+};
+
+// The client-side handle of a range-partitioned data structure. Shards are
+// split once they exceed max_shard_size entries and merged once they shrink.
+// Inserts and push_backs are buffered and shipped in batches of up to
+// max_batch_size entries; reads flush the buffers first. Operations on the
+// whole structure, e.g., size() and for_all(), are not atomic with respect to
+// concurrent splits and merges.
+template <typename Container>
+class ShardedDataStructure {
+ public:
+  using Key = Container::Key;
+  using Val = Container::Val;
+  using DataEntry = Container::DataEntry;
+  using Impl = Container::Implementation;
+  using Shard = GeneralShard<Container>;
+  using Mapping = ShardingMapping<Container>;
+
+  constexpr static uint32_t kDefaultMaxShardSize = 1 << 16;
+  constexpr static uint32_t kDefaultMaxBatchSize = 256;
+
+  ShardedDataStructure();
+  ShardedDataStructure(const ShardedDataStructure &);
+  ShardedDataStructure &operator=(const ShardedDataStructure &);
+  ShardedDataStructure(ShardedDataStructure &&);
+  ShardedDataStructure &operator=(ShardedDataStructure &&);
+  ~ShardedDataStructure();
+  void flush();
+  std::size_t size();
+  bool empty();
+  uint32_t num_shards();
+  template <typename... S0s, typename... S1s>
+  void for_all(void (*fn)(const Key &key, Val &val, S0s...),
+               S1s &&... states) requires HasVal<Impl>;
+  template <typename... S0s, typename... S1s>
+  void for_all(void (*fn)(const Key &key, S0s...),
+               S1s &&... states) requires(!HasVal<Impl>);
+
+  template <class Archive>
+  void save(Archive &ar) const;
+  template <class Archive>
+  void load(Archive &ar);
+
+ protected:
+  ShardedDataStructure(uint32_t max_shard_size, uint32_t max_batch_size);
+  void __insert(DataEntry entry) requires InsertAble<Impl>;
+  void __push_back(Val v) requires PushBackAble<Impl>;
+  bool __erase(Key k) requires EraseAble<Impl>;
+  template <typename RetT, typename... S0s, typename... S1s>
+  RetT compute_on(Key k, RetT (*fn)(Impl &, Key, S0s...), S1s &&... states);
+
+ private:
+  Proclet<Mapping> mapping_;
+  uint32_t max_batch_size_;
+  std::map<std::optional<Key>, WeakProclet<Shard>> key_to_shards_;
+  // The version of the mapping snapshot behind key_to_shards_.
+  std::optional<uint64_t> mapping_version_;
+  std::vector<DataEntry> insert_reqs_;
+  std::vector<Val> push_back_reqs_;
+
+  void sync_mapping();
+  void release_mapping();
+  WeakProclet<Shard> &locate(const Key &k);
+  void flush_insert_reqs() requires InsertAble<Impl>;
+  void flush_push_back_reqs() requires PushBackAble<Impl>;
+  template <typename RetT, typename... S0s, typename... S1s>
+  std::vector<Future<RetT>> compute_on_all(RetT (*fn)(Impl &, S0s...),
+                                           S1s &&... states);
+};
+
+}  // namespace nu
+
+#include "nu/impl/sharded_ds.ipp"
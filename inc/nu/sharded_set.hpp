@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+
+#include "nu/commons.hpp"
+#include "nu/container.hpp"
+#include "nu/sharded_ds.hpp"
+
+namespace nu {
+
+template <typename K>
+class SetImpl {
+ public:
+  using Key = K;
+  using Val = ErasedType;
+
+  std::size_t size() const;
+  bool empty() const;
+  void clear();
+  std::size_t insert(Key k);
+  bool erase(Key k);
+  bool contains(const Key &k) const;
+  // Moves the larger half of the keys, starting from *mid_k, into
+  // latter_half.
+  void split(Key *mid_k, SetImpl *latter_half);
+  void merge(SetImpl set);
+  template <typename... S0s, typename... S1s>
+  void for_all(void (*fn)(const Key &key, S0s...), S1s &&... states);
+
+  template <class Archive>
+  void serialize(Archive &ar);
+
+ private:
+  std::set<K> set_;
+};
+
+template <typename K>
+class ShardedSet
+    : public ShardedDataStructure<GeneralLockedContainer<SetImpl<K>>> {
+ public:
+  using Base = ShardedDataStructure<GeneralLockedContainer<SetImpl<K>>>;
+
+  ShardedSet() = default;
+  void insert(K k);
+  bool erase(K k);
+  bool contains(K k);
+
+ private:
+  ShardedSet(uint32_t max_shard_size, uint32_t max_batch_size);
+
+  template <typename K1>
+  friend ShardedSet<K1> make_sharded_set(uint32_t, uint32_t);
+};
+
+template <typename K>
+ShardedSet<K> make_sharded_set(
+    uint32_t max_shard_size = ShardedSet<K>::Base::kDefaultMaxShardSize,
+    uint32_t max_batch_size = ShardedSet<K>::Base::kDefaultMaxBatchSize);
+
+}  // namespace nu
+
+#include "nu/impl/sharded_set.ipp"
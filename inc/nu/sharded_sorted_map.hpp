@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+#include "nu/container.hpp"
+#include "nu/sharded_ds.hpp"
+
+namespace nu {
+
+template <typename K, typename V>
+class SortedMapImpl {
+ public:
+  using Key = K;
+  using Val = V;
+
+  std::size_t size() const;
+  bool empty() const;
+  void clear();
+  std::size_t insert(Key k, Val v);
+  bool erase(Key k);
+  std::optional<Val> get(const Key &k) const;
+  // Moves the larger half of the entries, starting from *mid_k, into
+  // latter_half.
+  void split(Key *mid_k, SortedMapImpl *latter_half);
+  void merge(SortedMapImpl map);
+  template <typename... S0s, typename... S1s>
+  void for_all(void (*fn)(const Key &key, Val &val, S0s...),
+               S1s &&... states);
+
+  template <class Archive>
+  void serialize(Archive &ar);
+
+ private:
+  std::map<K, V> map_;
+};
+
+template <typename K, typename V>
+class ShardedSortedMap
+    : public ShardedDataStructure<GeneralLockedContainer<SortedMapImpl<K, V>>> {
+ public:
+  using Base =
+      ShardedDataStructure<GeneralLockedContainer<SortedMapImpl<K, V>>>;
+
+  ShardedSortedMap() = default;
+  void insert(K k, V v);
+  bool erase(K k);
+  std::optional<V> find_data(K k);
+
+ private:
+  ShardedSortedMap(uint32_t max_shard_size, uint32_t max_batch_size);
+
+  template <typename K1, typename V1>
+  friend ShardedSortedMap<K1, V1> make_sharded_sorted_map(uint32_t, uint32_t);
+};
+
+template <typename K, typename V>
+ShardedSortedMap<K, V> make_sharded_sorted_map(
+    uint32_t max_shard_size =
+        ShardedSortedMap<K, V>::Base::kDefaultMaxShardSize,
+    uint32_t max_batch_size =
+        ShardedSortedMap<K, V>::Base::kDefaultMaxBatchSize);
+
+}  // namespace nu
+
+#include "nu/impl/sharded_sorted_map.ipp"
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "nu/container.hpp"
+#include "nu/sharded_ds.hpp"
+
+namespace nu {
+
+// The elements of one shard of a ShardedVector, indexed from l_key.
+template <typename T>
+class VectorImpl {
+ public:
+  using Key = std::size_t;
+  using Val = T;
+
+  VectorImpl();
+  std::size_t size() const;
+  bool empty() const;
+  void clear();
+  std::size_t push_back(Val v);
+  void push_back_batch(std::vector<Val> vs);
+  std::optional<Val> get(Key idx) const;
+  bool set(Key idx, Val v);
+  // Since a vector only grows at its tail, the latter half starts out empty
+  // and this shard is sealed.
+  void split(Key *mid_k, VectorImpl *latter_half);
+  void merge(VectorImpl vector);
+  Key rebase(Key new_l_key);
+  template <typename... S0s, typename... S1s>
+  void for_all(void (*fn)(const Key &key, Val &val, S0s...),
+               S1s &&... states);
+
+  template <class Archive>
+  void serialize(Archive &ar);
+
+ private:
+  Key l_key_;
+  std::vector<Val> data_;
+};
+
+template <typename T>
+class ShardedVector
+    : public ShardedDataStructure<GeneralLockedContainer<VectorImpl<T>>> {
+ public:
+  using Base = ShardedDataStructure<GeneralLockedContainer<VectorImpl<T>>>;
+
+  ShardedVector() = default;
+  void push_back(T v);
+  T operator[](std::size_t idx);
+  std::optional<T> find_data(std::size_t idx);
+  void set(std::size_t idx, T v);
+
+ private:
+  ShardedVector(uint32_t max_shard_size, uint32_t max_batch_size);
+
+  template <typename U>
+  friend ShardedVector<U> make_sharded_vector(uint32_t, uint32_t);
+};
+
+template <typename T>
+ShardedVector<T> make_sharded_vector(
+    uint32_t max_shard_size = ShardedVector<T>::Base::kDefaultMaxShardSize,
+    uint32_t max_batch_size = ShardedVector<T>::Base::kDefaultMaxBatchSize);
+
+}  // namespace nu
+
+#include "nu/impl/sharded_vector.ipp"
@@ -1,26 +1,36 @@
 #pragma once
 
 #include <sync.h>
+#include <thread.h>
 
 #include <cstdint>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "nu/commons.hpp"
 #include "nu/rpc_server.hpp"
 #include "nu/utils/cached_pool.hpp"
+#include "nu/utils/spin_lock.hpp"
 
 namespace nu {
 
-struct RPCReqGCStack {
+struct RPCReqGCStacks {
   RPCReqType rpc_type = kGCStack;
-  uint8_t *stack;
+  uint32_t num;
+  uint8_t *stacks[0];
 } __attribute__((packed));
 
 class StackManager {
  public:
   constexpr static uint32_t kPerCoreCacheSize = 32;
+  // The stacks of migrated-in threads are handed back to their creators in
+  // the background, in batches of up to kMaxGCBatchSize stacks per RPC.
+  constexpr static uint32_t kMaxGCBatchSize = 1024;
+  constexpr static uint64_t kGCIntervalUs = 1000;
 
   StackManager(VAddrRange stack_cluster);
+  ~StackManager();
   uint8_t *get();
   void put(uint8_t *stack);
   void free(uint8_t *stack);
@@ -32,8 +42,15 @@ class StackManager {
 
   VAddrRange range_;
   CachedPool<uint8_t> cached_pool_;
+  // Not-owned stacks pending to be returned, keyed by their creators.
+  std::unordered_map<NodeIP, std::vector<uint8_t *>> pending_gcs_;
+  SpinLock pending_gcs_spin_;
+  bool done_;
+  rt::Thread gc_thread_;
 
   bool not_owned(uint8_t *stack);
+  void gc_pending();
+  void free_batch(std::vector<uint8_t *> &stacks);
 };
 
 }  // namespace nu
@@ -5,6 +5,9 @@
 #include <spanstream>
 #include <sstream>
 #include <utility>
+#include <vector>
+
+#include <sys/uio.h>
 
 #include "nu/utils/cached_pool.hpp"
 
@@ -25,12 +28,17 @@ class ArchivePool {
   struct IASStream {
     std::spanstream ss;
     cereal::BinaryInputArchive ia;
-    IASStream() : ss{std::span<char>()}, ia(ss) {}
+    // Bulk segments are laid out backwards from the end of the request. This
+    // points right past the next one.
+    const std::byte *bulk_cursor;
+    IASStream() : ss{std::span<char>()}, ia(ss), bulk_cursor(nullptr) {}
   };
 
   struct OASStream {
     StringStream ss;
     cereal::BinaryOutputArchive oa;
+    // Segments sent in place after ss, see IASStream::bulk_cursor.
+    std::vector<iovec> bulk_segs;
     OASStream() : ss(String(kOAStreamPreallocBufSize, '\0')), oa(ss) {}
   };
 
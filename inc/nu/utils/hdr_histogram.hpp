@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace nu {
+
+// A log-linear latency histogram in the spirit of HdrHistogram. Values below
+// 2^kSubBucketBits are recorded exactly; larger values are bucketed with a
+// relative error bounded by 2^-(kSubBucketBits - 1). Recording is O(1) and
+// allocation-free, so it is cheap enough to sit on the request path.
+class HdrHistogram {
+ public:
+  constexpr static uint32_t kSubBucketBits = 8;
+  constexpr static uint32_t kMaxValueBits = 40;
+
+  HdrHistogram();
+  void record(uint64_t val);
+  void merge(const HdrHistogram &o);
+  void reset();
+  bool empty() const;
+  uint64_t count() const;
+  uint64_t max() const;
+  uint64_t mean() const;
+  // Returns the highest value equivalent to the nth (0-100) percentile.
+  uint64_t percentile(double nth) const;
+
+ private:
+  constexpr static uint64_t kHalfSubBucketCnt = 1ULL << (kSubBucketBits - 1);
+  constexpr static uint64_t kMaxValue = (1ULL << kMaxValueBits) - 1;
+  constexpr static uint64_t kNumBuckets =
+      (kMaxValueBits - kSubBucketBits + 2) * kHalfSubBucketCnt;
+
+  std::vector<uint64_t> cnts_;
+  uint64_t total_cnt_;
+  uint64_t total_sum_;
+  uint64_t max_;
+
+  static uint32_t bucket_idx(uint64_t val);
+  static uint64_t highest_equivalent_val(uint32_t idx);
+};
+
+}  // namespace nu
+
+#include "nu/impl/hdr_histogram.ipp"
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nu {
+
+// A minimal, dependency-free compressor emitting the LZ4 block format. It
+// trades ratio for speed (single-probe hash table, no lazy matching), which
+// is what we want on the migration path where it has to keep up with the NIC.
+class LZ4 {
+ public:
+  constexpr static uint64_t kMaxInputSize = 1 << 16;
+
+  // The worst-case compressed size of len input bytes.
+  constexpr static uint64_t compress_bound(uint64_t len);
+  // Returns the compressed size, or 0 if the output won't fit in dst_cap.
+  uint64_t compress(const std::byte *src, uint64_t len, std::byte *dst,
+                    uint64_t dst_cap);
+  // Returns the decompressed size, or -1 if the input is malformed.
+  static int64_t decompress(const std::byte *src, uint64_t len, std::byte *dst,
+                            uint64_t dst_cap);
+
+ private:
+  constexpr static uint32_t kHashLog = 12;
+  constexpr static uint32_t kMinMatch = 4;
+  constexpr static uint32_t kLastLiterals = 5;
+  constexpr static uint32_t kMatchFindLimit = 12;
+
+  uint16_t hash_table_[1 << kHashLog];
+};
+
+}  // namespace nu
+
+#include "nu/impl/lz4.ipp"
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <openssl/md5.h>
 
 #include <string>
@@ -13,6 +13,7 @@ extern "C" {
 #include <thread.h>
 
 #include "nu/commons.hpp"
+#include "nu/utils/hdr_histogram.hpp"
 
 namespace nu {
 
@@ -31,6 +32,20 @@ struct Trace {
   uint64_t duration_us;
 };
 
+// A phase of an open-loop rate schedule. The offered load ramps linearly from
+// start_mops to end_mops over duration_us; a step is a phase with equal rates
+// and a spike is a short high-rate step between two base-rate steps.
+struct PerfPhase {
+  uint64_t duration_us;
+  double start_mops;
+  double end_mops;
+
+  static PerfPhase step(double mops, uint64_t duration_us);
+  static PerfPhase ramp(double start_mops, double end_mops,
+                        uint64_t duration_us);
+  double mops_at(uint64_t offset_us) const;
+};
+
 struct PerfThreadState {
   virtual ~PerfThreadState() = default;
 };
@@ -53,19 +68,35 @@ class Perf {
                          uint32_t num_threads, double target_mops,
                          uint64_t duration_us, uint64_t warmup_us = 0,
                          uint64_t miss_ddl_thresh_us = 500);
+  // Open-loop, poisson arrival following the rate schedule of `phases`.
+  // Requests are generated lazily when issued and their latencies are
+  // measured from the intended start time, so a stalled server shows up in
+  // the tail instead of silently slowing down the offered load.
+  void run_open_loop(std::span<const PerfPhase> phases, uint32_t num_threads,
+                     uint64_t warmup_us = 0);
+  void run_open_loop_multi_clients(std::span<const netaddr> client_addrs,
+                                   std::span<const PerfPhase> phases,
+                                   uint32_t num_threads,
+                                   uint64_t warmup_us = 0);
   uint64_t get_average_lat();
   uint64_t get_nth_lat(double nth);
   std::vector<Trace> get_timeseries_nth_lats(uint64_t interval_us, double nth);
+  uint64_t get_phase_nth_lat(uint32_t phase_idx, double nth) const;
   double get_real_mops() const;
   const std::vector<Trace> &get_traces() const;
 
  private:
   enum TraceFormat { kUnsorted, kSortedByDuration, kSortedByStart };
 
+  struct OpenLoopLane;
+
   PerfAdapter &adapter_;
   std::vector<Trace> traces_;
   TraceFormat trace_format_;
   double real_mops_;
+  bool open_loop_;
+  HdrHistogram histogram_;
+  std::vector<HdrHistogram> phase_histograms_;
   friend class Test;
 
   void tcp_barrier(std::span<const netaddr> participant_addrs);
@@ -80,6 +111,12 @@ class Perf {
       std::vector<PerfRequestWithTime> *all_reqs,
       const std::vector<std::unique_ptr<PerfThreadState>> &thread_states,
       uint32_t num_threads, std::optional<uint64_t> miss_ddl_thresh_us);
+  void dispatch_open_loop(OpenLoopLane *lane, std::span<const PerfPhase> phases,
+                          uint32_t num_lanes, uint64_t start_us);
+  void benchmark_open_loop(
+      std::span<const PerfPhase> phases,
+      const std::vector<std::unique_ptr<PerfThreadState>> &thread_states,
+      uint32_t num_threads, bool record);
 };
 
 }  // namespace nu
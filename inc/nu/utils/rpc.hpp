@@ -8,12 +8,15 @@
 #include <vector>
 #include <climits>
 
+#include <sys/uio.h>
+
 #include <net.h>
 #include <sync.h>
 #include <thread.h>
 
 #include "nu/commons.hpp"
 #include "nu/utils/counter.hpp"
+#include "nu/utils/rpc_conn.hpp"
 
 namespace nu {
 
@@ -68,18 +71,30 @@ class RPCReturnBuffer {
   std::move_only_function<void()> deleter_fn_;
 };
 
-enum RPCReturnCode { kErrWrongClient = -2, kErrTimeout = -1, kOk = 0 };
+enum RPCReturnCode {
+  // The response has been delivered to the client by another server.
+  kDirectlyReturned = -3,
+  kErrWrongClient = -2,
+  kErrTimeout = -1,
+  kOk = 0
+};
 
 class RPCReturner {
  public:
   RPCReturner() {}
-  RPCReturner(void *rpc_server, std::size_t completion_data);
+  RPCReturner(void *rpc_server, uint32_t client_ip,
+              std::size_t completion_data);
   void Return(RPCReturnCode rc, std::span<const std::byte> buf,
               std::move_only_function<void()> deleter_fn = nullptr);
   void Return(RPCReturnCode rc);
+  // The return address, which stays valid on other servers so that they can
+  // complete the RPC through RPCClient::CompleteDirectly().
+  uint32_t get_client_ip() const { return client_ip_; }
+  std::size_t get_completion_data() const { return completion_data_; }
 
  private:
   void *rpc_server_;
+  uint32_t client_ip_;
   std::size_t completion_data_;
 };
 
@@ -87,7 +102,7 @@ class RPCReturner {
 using RPCHandler = std::move_only_function<void(std::span<std::byte> args,
                                                 RPCReturner *rpc_returner)>;
 // A callback for each RPC request, invoked when the response data is ready.
-using RPCCallback = std::move_only_function<void(ssize_t len, rt::TcpConn *c)>;
+using RPCCallback = std::move_only_function<void(ssize_t len, RPCConn *c)>;
 
 namespace rpc_internal {
 
@@ -96,45 +111,67 @@ class RPCServerWorker;
 // RPCCompletion manages the completion of an inflight request.
 class RPCCompletion {
  public:
-  RPCCompletion(RPCReturnBuffer *return_buf)
-      : return_buf_(return_buf), poll_(!preempt_enabled()) {
-    if (!poll_) {
+  // The caller of a tracked completion does not park right after issuing the
+  // request, but waits in WaitSent() and then in WaitDone(). Requests with bulk
+  // segments must be tracked.
+  RPCCompletion(RPCReturnBuffer *return_buf, bool tracked = false)
+      : return_buf_(return_buf), poll_(!preempt_enabled()), tracked_(tracked) {
+    if (!poll_ && !tracked_) {
       w_.Arm();
     }
   }
   RPCCompletion(RPCCallback &&callback)
-      : callback_(std::move(callback)), poll_(!preempt_enabled()) {
+      : callback_(std::move(callback)),
+        poll_(!preempt_enabled()),
+        tracked_(false) {
     w_.Arm();
   }
   ~RPCCompletion() {}
 
   // Complete the request by invoking the callback and waking up the blocking
   // thread.
-  void Done(ssize_t len, rt::TcpConn *c);
+  void Done(RPCReturnCode rc, std::size_t len, RPCConn *c);
+  // Complete the request with a response that did not arrive on its flow.
+  void Done(RPCReturnCode rc, std::span<const std::byte> buf);
+
+  // Called by the flow once the request, including its bulk segments, has
+  // been written, so that the caller may release them.
+  void Sent();
 
   RPCReturnCode get_return_code() const {
     Poll();
     return rc_;
   }
 
+  // Block until Sent() and Done() respectively, for tracked completions only.
+  void WaitSent();
+  RPCReturnCode WaitDone();
+
  private:
   void Poll() const;
+  void Finish();
+  void WaitFor(const bool *flag);
 
   RPCReturnCode rc_;
-  RPCReturnBuffer *return_buf_;
+  RPCReturnBuffer *return_buf_ = nullptr;
   RPCCallback callback_;
   rt::ThreadWaker w_;
   bool poll_;
+  bool tracked_;
+  // Only used by tracked completions.
+  bool sent_ = false;
+  bool done_ = false;
+  rt::Spin lock_;
 };
 
-// RPCFlow encapsulates one of the TCP connections used by an RPCClient.
+// RPCFlow encapsulates one of the connections used by an RPCClient.
 class RPCFlow {
  public:
   constexpr static bool kEnableAdaptiveBatching = true;
   constexpr static uint64_t kReqBatchSize = 4;
   constexpr static uint64_t kBatchTimeoutUs = 5;
 
-  RPCFlow(std::unique_ptr<rt::TcpConn> c)
+  RPCFlow(std::unique_ptr<RPCConn> c)
       : close_(false),
         c_(std::move(c)),
         sent_count_(0),
@@ -145,8 +182,11 @@ class RPCFlow {
   // A factory to create new flows with CPU affinity.
   static std::unique_ptr<RPCFlow> New(unsigned int cpu_affinity, netaddr raddr);
 
-  // Make an RPC call over this flow.
-  void Call(std::span<const std::byte> src, RPCCompletion *c);
+  // Make an RPC call over this flow. The bulk segments are sent right after
+  // src as part of the same request, and the completion must be tracked if
+  // there are any.
+  void Call(std::span<const std::byte> src, std::span<const iovec> bulk,
+            RPCCompletion *c);
 
   // Disable move and copy.
   RPCFlow(const RPCFlow &) = delete;
@@ -156,6 +196,7 @@ class RPCFlow {
   // State for managing inflight requests.
   struct req_ctx {
     std::span<const std::byte> payload;
+    std::span<const iovec> bulk;
     RPCCompletion *completion;
   };
 
@@ -168,7 +209,7 @@ class RPCFlow {
   rt::Spin lock_;
   bool close_;
   rt::ThreadWaker wake_sender_;
-  std::unique_ptr<rt::TcpConn> c_;
+  std::unique_ptr<RPCConn> c_;
   unsigned int sent_count_;
   unsigned int recv_count_;
   unsigned int credits_;
@@ -182,19 +223,33 @@ class RPCClient {
  public:
   ~RPCClient(){};
 
-  // Creates an RPC Client and establishes the underlying TCP connections.
+  // Creates an RPC Client and establishes the underlying connections, which
+  // use shared memory if the server runs on the same host.
   static std::unique_ptr<RPCClient> Dial(netaddr raddr);
 
   // Calls an RPC method, the RPC layer allocates a return buffer and stores
   // response into it.
   RPCReturnCode Call(std::span<const std::byte> args, RPCReturnBuffer *buf);
 
+  // Same as above, except that the request is followed by the bulk segments,
+  // which are sent in place. They must stay valid until sent_fn is invoked on
+  // the calling thread, which happens once they have been written.
+  RPCReturnCode Call(std::span<const std::byte> args,
+                     std::span<const iovec> bulk_args, RPCReturnBuffer *buf,
+                     std::move_only_function<void()> &&sent_fn);
+
   // Calls an RPC method, the RPC layer invokes the callback when the response
-  // is ready on the TCP connection.
+  // is ready on the connection.
   RPCReturnCode Call(std::span<const std::byte> args, RPCCallback &&callback);
 
   netaddr GetAddr() { return raddr_; }
 
+  // Completes an inflight RPC issued by this node with a response sent by a
+  // server other than the one it was issued to. The original server must
+  // return kDirectlyReturned on the flow.
+  static void CompleteDirectly(std::size_t completion_data, RPCReturnCode rc,
+                               std::span<const std::byte> buf);
+
   // disable move and copy.
   RPCClient(const RPCClient &) = delete;
   RPCClient &operator=(const RPCClient &) = delete;
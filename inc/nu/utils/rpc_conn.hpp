@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include <sys/uio.h>
+
+#include <net.h>
+#include <sync.h>
+
+namespace nu {
+
+// RPCConn is the byte stream underneath an RPC flow. It always starts as a TCP
+// connection. When both ends turn out to run on the same host, they move the
+// stream into a pair of lock-free SPSC rings in a shared mapping, and keep the
+// TCP connection only as a doorbell to wake up a reader parked on an empty
+// ring or a writer parked on a full one.
+class RPCConn {
+ public:
+  constexpr static bool kEnableShm = true;
+  constexpr static std::size_t kShmRingSize = 1 << 20;
+  // How long a reader (writer) polls an empty (full) ring before parking.
+  constexpr static uint64_t kShmPollUs = 20;
+  // How often a writer parked on a full ring checks that the peer is alive.
+  // The space bell that wakes it up is only consumed while the local reader
+  // waits on the doorbell, so this also bounds how long it may oversleep.
+  constexpr static uint64_t kShmProbeIntervalUs = 10000;
+
+  // Wraps an accepted TCP connection; Accept() must be called before any I/O.
+  explicit RPCConn(std::unique_ptr<rt::TcpConn> c);
+  ~RPCConn();
+
+  // Dials raddr with CPU affinity and negotiates the transport. Stays on TCP
+  // if allow_shm is false.
+  static std::unique_ptr<RPCConn> Dial(unsigned int cpu_affinity,
+                                       netaddr raddr,
+                                       bool allow_shm = kEnableShm);
+  // The server side of the transport negotiation. Returns false if the
+  // connection broke in the middle.
+  bool Accept();
+
+  // Reads exactly len bytes. Returns 0 at the end of the stream.
+  ssize_t ReadFull(void *buf, std::size_t len);
+  // Writes exactly a vector of bytes.
+  ssize_t WritevFull(std::span<const iovec> iov);
+  int Shutdown(int how);
+  void Abort();
+
+  netaddr RemoteAddr() const { return c_->RemoteAddr(); }
+  bool is_shm() const { return shm_; }
+
+  // disable move and copy.
+  RPCConn(const RPCConn &) = delete;
+  RPCConn &operator=(const RPCConn &) = delete;
+
+ private:
+  enum Bell : uint8_t;
+  struct ShmRing;
+
+  std::unique_ptr<rt::TcpConn> c_;
+  void *shm_;
+  ShmRing *tx_;
+  ShmRing *rx_;
+  // For parking the writer on a full tx ring.
+  rt::TimedMutex space_mutex_;
+  rt::TimedCondVar space_cv_;
+
+  bool Negotiate(bool allow_shm);
+  bool MapShm(const char *name, bool create);
+  bool WaitForRead();
+  // The following return false if the connection is broken.
+  bool WaitForSpace();
+  bool SendBell(Bell bell);
+  bool RingDoorbell();
+  bool RingSpaceBell();
+  void WakeWriter();
+};
+
+}  // namespace nu
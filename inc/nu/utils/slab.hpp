@@ -78,6 +78,14 @@ class SlabAllocator {
     FreePtrsLinkedList lists[kMaxSlabClassShift];
   };
 
+  // Carved out of the slab region on the first use by each core, so that
+  // small slabs only pay for the cores that touched them and the caches migrate
+  // along with the heap.
+  struct CoreCaches {
+    CoreCache cache;
+    TransferredCoreCache transferred;
+  };
+
   static SlabAllocator *slabs_[get_max_slab_id() + 1];
   SlabId_t slab_id_;
   bool aggressive_caching_;
@@ -86,13 +94,13 @@ class SlabAllocator {
   uint8_t *cur_;
   FreePtrsLinkedList slab_lists_[kMaxSlabClassShift];
   uint64_t global_free_bytes_;
-  CoreCache cache_lists_[kNumCores];
-  TransferredCoreCache transferred_caches_[kNumCores];
+  CoreCaches *core_caches_[kNumCores];
   SpinLock spin_;
 
   uint32_t get_slab_shift(uint64_t data_size);
   uint64_t get_slab_size(uint32_t slab_shift);
   void *__allocate(size_t size);
+  CoreCaches *get_or_create_core_caches(uint32_t cpu);
   static void __free(const void *ptr);
   void __do_free(const Caladan::PreemptGuard &g, PtrHeader *ptr,
                  uint32_t slab_shift);
@@ -6,6 +6,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -57,6 +58,17 @@ class SyncHashMap {
                           void (*reduce_fn)(RetT &, std::pair<const K, V> &,
                                             A0s...),
                           A1s &&...args);
+  // Like associative_reduce() but starts from bucket *bucket_idx and stops
+  // before the first bucket beyond max_num_pairs reduced pairs. Buckets are
+  // never split. Advances *bucket_idx past the covered buckets, i.e., to
+  // NBuckets once all are covered. max_num_pairs must be positive.
+  template <typename RetT, typename... A0s, typename... A1s>
+  RetT associative_reduce_range(uint64_t *bucket_idx, uint64_t max_num_pairs,
+                                RetT init_val,
+                                void (*reduce_fn)(RetT &,
+                                                  std::pair<const K, V> &,
+                                                  A0s...),
+                                A1s &&...args);
   template <typename K1>
   std::optional<V> get_and_remove(K1 &&k);
   std::vector<std::pair<K, V>> get_all_pairs();
@@ -80,12 +80,14 @@ CaladanOptionsDesc::CaladanOptionsDesc(int default_guaranteed,
     ("kthreads,k", boost::program_options::value(&kthreads)->default_value(max_num_kthreads), "number of kthreads (if conf unspecified)")
     ("guaranteed,g", boost::program_options::value(&guaranteed)->default_value(default_guaranteed), "number of guaranteed kthreads (if conf unspecified)")
     ("spinning,p", boost::program_options::value(&spinning)->default_value(default_spinning), "number of spinning kthreads (if conf unspecified)")
+    ("socket,s", boost::program_options::value(&socket)->default_value(0), "NUMA node to run on (if conf unspecified)")
     ("ip,i", ip_opt, "IP address (if conf unspecified)")
     ("netmask,n", boost::program_options::value(&netmask)->default_value("255.255.255.0"), "netmask (if conf unspecified)")
     ("gateway,w", boost::program_options::value(&gateway)->default_value("18.18.1.1"), "gateway address (if conf unspecified)");
   add_either_constraint("conf", "kthreads");
   add_either_constraint("conf", "guaranteed");
   add_either_constraint("conf", "spinning");
+  add_either_constraint("conf", "socket");
   add_either_constraint("conf", "ip");
   add_either_constraint("conf", "netmask");
   add_either_constraint("conf", "gateway");
@@ -116,6 +118,7 @@ void write_options_to_file(std::string path, const CaladanOptionsDesc &desc) {
   ofs << "runtime_kthreads " << desc.kthreads << std::endl;
   ofs << "runtime_guaranteed_kthreads " << desc.guaranteed << std::endl;
   ofs << "runtime_spinning_kthreads " << desc.spinning << std::endl;
+  ofs << "preferred_socket " << desc.socket << std::endl;
   ofs << "runtime_priority " << kPriority << std::endl;
   ofs << "runtime_qdelay_us " << kQDelayUs << std::endl;
   ofs << "enable_directpath 1" << std::endl;
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cereal/archives/binary.hpp>
 #include <cstdint>
 #include <limits>
+#include <memory>
 
 extern "C" {
 #include <base/assert.h>
@@ -43,7 +45,7 @@ Controller::Controller() {
        start_addr += kMaxProcletHeapSize) {
     VAddrRange range = {.start = start_addr,
                         .end = start_addr + kMaxProcletHeapSize};
-    highest_bucket.push({range, 0});
+    highest_bucket.push_back({range, 0});
   }
 
   for (uint64_t start_addr = kMinStackClusterVAddr;
@@ -171,36 +173,50 @@ void Controller::destroy_lp(lpid_t lpid, NodeIP requestor_ip) {
 }
 
 std::optional<std::pair<ProcletID, NodeIP>> Controller::allocate_proclet(
-    uint64_t capacity, lpid_t lpid, NodeIP ip_hint) {
+    uint64_t capacity, lpid_t lpid, NodeIP ip_hint, ProcletID id_hint) {
   ScopedLock lock(&mutex_);
 
   auto &bucket =
       free_proclet_heap_segments_[get_proclet_segment_bucket_id(capacity)];
-  if (unlikely(bucket.empty())) {
-    auto &highest_bucket =
-        free_proclet_heap_segments_[kNumProcletSegmentBuckets - 1];
-    if (unlikely(highest_bucket.empty())) {
+  auto &highest_bucket =
+      free_proclet_heap_segments_[kNumProcletSegmentBuckets - 1];
+  // Without an ID hint, any segment (i.e., the top of the stack) will do.
+  auto matches_hint = [&](const ProcletHeapSegment &segment) {
+    return !id_hint ||
+           (segment.range.start <= id_hint && id_hint < segment.range.end);
+  };
+
+  auto iter = std::find_if(bucket.rbegin(), bucket.rend(), matches_hint);
+  if (unlikely(iter == bucket.rend())) {
+    auto max_iter = std::find_if(highest_bucket.rbegin(), highest_bucket.rend(),
+                                 matches_hint);
+    if (unlikely(max_iter == highest_bucket.rend())) {
       return std::nullopt;
     }
-    auto max_segment = highest_bucket.top();
-    highest_bucket.pop();
+    auto max_segment = *max_iter;
+    highest_bucket.erase(std::next(max_iter).base());
     for (auto start_addr = max_segment.range.start;
          start_addr < max_segment.range.end; start_addr += capacity) {
       VAddrRange range = {.start = start_addr, .end = start_addr + capacity};
-      bucket.push({range, max_segment.prev_host});
+      bucket.push_back({range, max_segment.prev_host});
     }
+    iter = std::find_if(bucket.rbegin(), bucket.rend(), matches_hint);
   }
 
-  auto segment = bucket.top();
-  bucket.pop();
+  auto segment = *iter;
   auto start_addr = segment.range.start;
+  if (unlikely(id_hint && start_addr != id_hint)) {
+    return std::nullopt;
+  }
+  bucket.erase(std::next(iter).base());
   auto id = start_addr;
   auto node_ip = select_node_for_proclet(lpid, ip_hint, segment);
   if (unlikely(!node_ip)) {
+    bucket.push_back(segment);
     return std::nullopt;
   }
-  auto [iter, _] = proclet_id_to_ip_.try_emplace(id);
-  iter->second = node_ip;
+  auto [map_iter, _] = proclet_id_to_ip_.try_emplace(id);
+  map_iter->second = node_ip;
   return std::make_pair(id, node_ip);
 }
 
@@ -216,7 +232,7 @@ void Controller::destroy_proclet(VAddrRange proclet_segment) {
     WARN();
     return;
   }
-  bucket.push({proclet_segment, iter->second});
+  bucket.push_back({proclet_segment, iter->second});
   proclet_id_to_ip_.erase(iter);
 }
 
@@ -339,8 +355,97 @@ void Controller::update_location(ProcletID id, NodeIP proclet_srv_ip) {
   auto iter = proclet_id_to_ip_.find(id);
   BUG_ON(iter == proclet_id_to_ip_.end());
   iter->second = proclet_srv_ip;
+  if constexpr (kEnableLocationPush) {
+    pending_location_updates_.push_back({id, proclet_srv_ip});
+  }
+}
+
+void Controller::subscribe_locations(NodeIP ip) {
+  if constexpr (kEnableLocationPush) {
+    ScopedLock lock(&mutex_);
+    location_subscribers_[ip].last_seen_us = microtime();
+  }
+}
+
+void Controller::push_location_updates() {
+  std::vector<ProcletLocation> updates;
+  std::vector<NodeIP> ips;
+
+  {
+    ScopedLock lock(&mutex_);
+
+    if (pending_location_updates_.empty()) {
+      return;
+    }
+    updates.swap(pending_location_updates_);
+
+    auto is_registered = [&](NodeIP ip) {
+      return std::any_of(lpid_to_info_.begin(), lpid_to_info_.end(),
+                         [&](const auto &p) {
+                           return !p.second.destroying &&
+                                  p.second.node_statuses.contains(ip);
+                         });
+    };
+
+    auto now_us = microtime();
+    for (auto iter = location_subscribers_.begin();
+         iter != location_subscribers_.end();) {
+      auto &[ip, subscriber] = *iter;
+      if (now_us - subscriber.last_seen_us > kLocationSubscriptionUs ||
+          !is_registered(ip)) {
+        iter = location_subscribers_.erase(iter);
+        continue;
+      }
+      // Pushes are only hints, so a subscriber that is still busy with the
+      // previous one just misses this one.
+      if (!subscriber.pushing) {
+        subscriber.pushing = true;
+        ips.push_back(ip);
+      }
+      iter++;
+    }
+  }
+
+  if (ips.empty()) {
+    return;
+  }
+
+  auto req_buf_len =
+      sizeof(RPCReqPushLocations) + std::span(updates).size_bytes();
+  auto req_buf = std::make_shared_for_overwrite<std::byte[]>(req_buf_len);
+  auto *req = reinterpret_cast<RPCReqPushLocations *>(req_buf.get());
+  std::construct_at(req);
+  req->num = updates.size();
+  std::copy(updates.begin(), updates.end(), req->locations);
+
+  // Sent off the pushing thread and without the lock held, so that neither
+  // the controller nor the other subscribers wait for a slow one.
+  location_pushes_.Add(ips.size());
+  for (auto ip : ips) {
+    rt::Spawn([this, ip, req_buf, req_buf_len] {
+      auto *client = get_runtime()->rpc_client_mgr()->get_by_ip(ip);
+      RPCReturnBuffer return_buf;
+      auto rc =
+          client->Call(std::span(req_buf.get(), req_buf_len), &return_buf);
+
+      {
+        ScopedLock lock(&mutex_);
+        auto iter = location_subscribers_.find(ip);
+        if (iter != location_subscribers_.end()) {
+          if (unlikely(rc != kOk)) {
+            location_subscribers_.erase(iter);
+          } else {
+            iter->second.pushing = false;
+          }
+        }
+      }
+      location_pushes_.Done();
+    });
+  }
 }
 
+void Controller::wait_for_location_pushes() { location_pushes_.Wait(); }
+
 std::vector<std::pair<NodeIP, Resource>> Controller::report_free_resource(
     lpid_t lpid, NodeIP ip, Resource free_resource) {
   std::vector<std::pair<NodeIP, Resource>> global_free_resources;
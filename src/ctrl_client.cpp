@@ -50,11 +50,12 @@ std::optional<std::pair<lpid_t, VAddrRange>> ControllerClient::register_node(
 }
 
 std::optional<std::pair<ProcletID, NodeIP>> ControllerClient::allocate_proclet(
-    uint64_t capacity, NodeIP ip_hint) {
+    uint64_t capacity, NodeIP ip_hint, ProcletID id_hint) {
   RPCReqAllocateProclet req;
   req.capacity = capacity;
   req.lpid = lpid_;
   req.ip_hint = ip_hint;
+  req.id_hint = id_hint;
   RPCReturnBuffer return_buf;
   BUG_ON(rpc_client_->Call(to_span(req), &return_buf) != kOk);
   auto &resp = from_span<RPCRespAllocateProclet>(return_buf.get_buf());
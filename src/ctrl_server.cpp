@@ -44,6 +44,15 @@ ControllerServer::ControllerServer()
     });
   }
 
+  if constexpr (Controller::kEnableLocationPush) {
+    location_push_thread_ = rt::Thread([&] {
+      while (!rt::access_once(done_)) {
+        timer_sleep(kLocationPushIntervalUs);
+        ctrl_.push_location_updates();
+      }
+    });
+  }
+
   netaddr laddr{.ip = 0, .port = kPort};
   tcp_queue_.reset(rt::TcpQueue::Listen(laddr, kTCPListenBackLog));
   BUG_ON(!tcp_queue_);
@@ -60,6 +69,8 @@ ControllerServer::~ControllerServer() {
   done_ = true;
   barrier();
   logging_thread_.Join();
+  location_push_thread_.Join();
+  ctrl_.wait_for_location_pushes();
 
   tcp_queue_.reset();
   barrier();
@@ -148,13 +159,16 @@ std::unique_ptr<RPCRespRegisterNode> ControllerServer::handle_register_node(
 }
 
 std::unique_ptr<RPCRespAllocateProclet>
-ControllerServer::handle_allocate_proclet(const RPCReqAllocateProclet &req) {
+ControllerServer::handle_allocate_proclet(const RPCReqAllocateProclet &req,
+                                          NodeIP requestor_ip) {
   if constexpr (kEnableLogging) {
     num_allocate_proclet_++;
   }
 
+  ctrl_.subscribe_locations(requestor_ip);
   auto resp = std::make_unique_for_overwrite<RPCRespAllocateProclet>();
-  auto optional = ctrl_.allocate_proclet(req.capacity, req.lpid, req.ip_hint);
+  auto optional = ctrl_.allocate_proclet(req.capacity, req.lpid, req.ip_hint,
+                                         req.id_hint);
   if (optional) {
     resp->empty = false;
     resp->id = optional->first;
@@ -175,11 +189,12 @@ void ControllerServer::handle_destroy_proclet(
 }
 
 std::unique_ptr<RPCRespResolveProclet> ControllerServer::handle_resolve_proclet(
-    const RPCReqResolveProclet &req) {
+    const RPCReqResolveProclet &req, NodeIP requestor_ip) {
   if constexpr (kEnableLogging) {
     num_resolve_proclet_++;
   }
 
+  ctrl_.subscribe_locations(requestor_ip);
   auto resp = std::make_unique_for_overwrite<RPCRespResolveProclet>();
   resp->ip = ctrl_.resolve_proclet(req.id);
   return resp;
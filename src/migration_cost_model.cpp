@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "nu/migration_cost_model.hpp"
+#include "nu/runtime.hpp"
+#include "nu/utils/scoped_lock.hpp"
+
+namespace nu {
+
+MigrationCostModel::Fit::Fit() {
+  memset(xtx, 0, sizeof(xtx));
+  memset(xty, 0, sizeof(xty));
+  coeffs[0] = kPriorFixedCostUs;
+  coeffs[1] = kPriorPerMBUs;
+  coeffs[2] = kPriorPerThreadUs;
+}
+
+MigrationCostModel::MigrationCostModel()
+    : fixed_us_(kPriorFixedCostUs),
+      per_mb_us_(kPriorPerMBUs),
+      per_thread_us_(kPriorPerThreadUs) {}
+
+void MigrationCostModel::solve(Fit *fit) {
+  constexpr float kPriors[kNumFeatures] = {kPriorFixedCostUs, kPriorPerMBUs,
+                                           kPriorPerThreadUs};
+
+  // Solves (X^T X + w I) c = X^T y + w c_prior by Gaussian elimination.
+  float m[kNumFeatures][kNumFeatures + 1];
+  for (uint32_t i = 0; i < kNumFeatures; i++) {
+    for (uint32_t j = 0; j < kNumFeatures; j++) {
+      m[i][j] = fit->xtx[i][j] + (i == j ? kPriorWeight : 0);
+    }
+    m[i][kNumFeatures] = fit->xty[i] + kPriorWeight * kPriors[i];
+  }
+
+  for (uint32_t i = 0; i < kNumFeatures; i++) {
+    auto pivot = i;
+    for (uint32_t j = i + 1; j < kNumFeatures; j++) {
+      if (std::fabs(m[j][i]) > std::fabs(m[pivot][i])) {
+        pivot = j;
+      }
+    }
+    if (unlikely(std::fabs(m[pivot][i]) < 1e-9f)) {
+      return;
+    }
+    std::swap(m[i], m[pivot]);
+    for (uint32_t j = 0; j < kNumFeatures; j++) {
+      if (j != i) {
+        auto factor = m[j][i] / m[i][i];
+        for (uint32_t k = i; k <= kNumFeatures; k++) {
+          m[j][k] -= factor * m[i][k];
+        }
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < kNumFeatures; i++) {
+    fit->coeffs[i] = std::max(m[i][kNumFeatures] / m[i][i], 0.0f);
+  }
+}
+
+void MigrationCostModel::record(NodeIP dest_ip,
+                                const MigrationSample &sample) {
+  float x[kNumFeatures] = {1, sample.mem_size / static_cast<float>(kOneMB),
+                           static_cast<float>(sample.num_threads)};
+  float y = sample.time_us;
+
+  RuntimeSlabGuard guard;
+  ScopedLock lock(&spin_);
+
+  auto &fit = fits_[dest_ip];
+  for (uint32_t i = 0; i < kNumFeatures; i++) {
+    for (uint32_t j = 0; j < kNumFeatures; j++) {
+      fit.xtx[i][j] = kDecay * fit.xtx[i][j] + x[i] * x[j];
+    }
+    fit.xty[i] = kDecay * fit.xty[i] + x[i] * y;
+  }
+  solve(&fit);
+
+  float sums[kNumFeatures] = {0, 0, 0};
+  for (auto &[_, f] : fits_) {
+    for (uint32_t i = 0; i < kNumFeatures; i++) {
+      sums[i] += f.coeffs[i];
+    }
+  }
+  fixed_us_ = sums[0] / fits_.size();
+  per_mb_us_ = sums[1] / fits_.size();
+  per_thread_us_ = sums[2] / fits_.size();
+}
+
+}  // namespace nu
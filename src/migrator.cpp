@@ -1,7 +1,11 @@
 #include <fcntl.h>
+#include <immintrin.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstring>
 #include <memory>
@@ -97,6 +101,15 @@ void MigratorConnManager::put(uint32_t ip, rt::TcpConn *tcp_conn) {
   pool_map_[ip].push(tcp_conn);
 }
 
+StripeEncoder::StripeEncoder() {
+  if constexpr (Migrator::kEnableCompression) {
+    gather_buf =
+        std::make_unique_for_overwrite<std::byte[]>(Migrator::kEncodedChunkSize);
+    compression_buf = std::make_unique_for_overwrite<std::byte[]>(
+        LZ4::compress_bound(Migrator::kEncodedChunkSize));
+  }
+}
+
 Migrator::Migrator() {
   callback_triggered_ = true;
   run_background_loop();
@@ -107,7 +120,7 @@ Migrator::~Migrator() {
   th_.Join();
 }
 
-void Migrator::handle_copy_proclet(rt::TcpConn *c) {
+void Migrator::handle_copy_proclet(rt::TcpConn *c, bool encoded) {
   ProcletHeader *proclet_header;
   uint64_t start_addr, len;
   const iovec iovecs[] = {{&proclet_header, sizeof(proclet_header)},
@@ -126,11 +139,214 @@ void Migrator::handle_copy_proclet(rt::TcpConn *c) {
     proclet_header->status() = kAbsent;
   }
 
-  BUG_ON(c->ReadFull(reinterpret_cast<uint8_t *>(start_addr), len,
-                     /* nt = */ true, /* poll = */ true) <= 0);
+  auto *dest = reinterpret_cast<std::byte *>(start_addr);
+  if (encoded) {
+    load_encoded(c, dest, len);
+  } else {
+    BUG_ON(c->ReadFull(dest, len, /* nt = */ true, /* poll = */ true) <= 0);
+  }
   proclet_header->pending_load_cnt--;
 }
 
+static inline bool is_zero_page(const std::byte *page) {
+#ifdef __AVX2__
+  auto *p = reinterpret_cast<const __m256i *>(page);
+  for (uint32_t i = 0; i < kPageSize / sizeof(__m256i); i += 4) {
+    auto v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_load_si256(p + i), _mm256_load_si256(p + i + 1)),
+        _mm256_or_si256(_mm256_load_si256(p + i + 2),
+                        _mm256_load_si256(p + i + 3)));
+    if (!_mm256_testz_si256(v, v)) {
+      return false;
+    }
+  }
+  return true;
+#else
+  auto *p = reinterpret_cast<const uint64_t *>(page);
+  for (uint32_t i = 0; i < kPageSize / sizeof(uint64_t); i += 4) {
+    if (p[i] | p[i + 1] | p[i + 2] | p[i + 3]) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+// Invokes fn(start, len) on every run of non-elided bytes in the chunk.
+template <typename F>
+static inline void for_each_chunk_run(uint64_t chunk_start, uint64_t chunk_end,
+                                      uint16_t zero_pages, F &&fn) {
+  auto chunk_base = chunk_start & ~(Migrator::kEncodedChunkSize - 1);
+  auto run_start = chunk_start;
+  for (; zero_pages; zero_pages &= zero_pages - 1) {
+    auto page = chunk_base + std::countr_zero(zero_pages) * kPageSize;
+    if (page > run_start) {
+      fn(run_start, page - run_start);
+    }
+    run_start = page + kPageSize;
+  }
+  if (chunk_end > run_start) {
+    fn(run_start, chunk_end - run_start);
+  }
+}
+
+static inline uint64_t next_chunk_end(uint64_t chunk_start, uint64_t end) {
+  auto chunk_base = chunk_start & ~(Migrator::kEncodedChunkSize - 1);
+  return std::min(chunk_base + Migrator::kEncodedChunkSize, end);
+}
+
+void Migrator::load_encoded(rt::TcpConn *c, std::byte *dest, uint64_t len) {
+  std::unique_ptr<std::byte[]> compressed_buf;
+  std::unique_ptr<std::byte[]> scatter_buf;
+  uint64_t zero_start = 0;
+  uint64_t zero_end = 0;
+
+  // Pages that weren't sent must read as zero. Short runs are cheaper to clear
+  // by hand; long ones are handed back to the (pre-zeroing) kernel.
+  auto zero_pending_range = [&] {
+    auto zero_len = zero_end - zero_start;
+    if (zero_len >= kMinMadviseZeroLen) {
+      BUG_ON(madvise(reinterpret_cast<void *>(zero_start), zero_len,
+                     MADV_DONTNEED) != 0);
+    } else if (zero_len) {
+      memset(reinterpret_cast<void *>(zero_start), 0, zero_len);
+    }
+    zero_start = zero_end = 0;
+  };
+
+  auto start = reinterpret_cast<uint64_t>(dest);
+  auto end = start + len;
+  for (auto chunk_start = start; chunk_start < end;) {
+    auto chunk_end = next_chunk_end(chunk_start, end);
+    EncodedChunkHeader hdr;
+    BUG_ON(c->ReadFull(&hdr, sizeof(hdr), /* nt = */ false,
+                       /* poll = */ true) <= 0);
+
+    iovec runs[kEncodedChunkSize / kPageSize];
+    uint32_t num_runs = 0;
+    uint64_t raw_len = 0;
+    for_each_chunk_run(chunk_start, chunk_end, hdr.zero_pages,
+                       [&](uint64_t run_start, uint64_t run_len) {
+                         runs[num_runs++] = {
+                             reinterpret_cast<void *>(run_start), run_len};
+                         raw_len += run_len;
+                       });
+
+    if (hdr.compressed) {
+      if (!compressed_buf) {
+        compressed_buf =
+            std::make_unique_for_overwrite<std::byte[]>(kEncodedChunkSize);
+        scatter_buf =
+            std::make_unique_for_overwrite<std::byte[]>(kEncodedChunkSize);
+      }
+      BUG_ON(c->ReadFull(compressed_buf.get(), hdr.payload_len,
+                         /* nt = */ false, /* poll = */ true) <= 0);
+      auto *decompressed = num_runs == 1
+                               ? reinterpret_cast<std::byte *>(runs[0].iov_base)
+                               : scatter_buf.get();
+      BUG_ON(LZ4::decompress(compressed_buf.get(), hdr.payload_len,
+                             decompressed,
+                             raw_len) != static_cast<int64_t>(raw_len));
+      if (num_runs > 1) {
+        for (uint32_t i = 0; i < num_runs; i++) {
+          memcpy(runs[i].iov_base, decompressed, runs[i].iov_len);
+          decompressed += runs[i].iov_len;
+        }
+      }
+    } else if (raw_len) {
+      BUG_ON(hdr.payload_len != raw_len);
+      BUG_ON(c->ReadvFull(std::span<const iovec>(runs, num_runs),
+                          /* nt = */ true, /* poll = */ true) <= 0);
+    }
+
+    auto chunk_base = chunk_start & ~(kEncodedChunkSize - 1);
+    for (auto zero_pages = hdr.zero_pages; zero_pages;
+         zero_pages &= zero_pages - 1) {
+      auto page = chunk_base + std::countr_zero(zero_pages) * kPageSize;
+      if (page != zero_end) {
+        zero_pending_range();
+        zero_start = page;
+      }
+      zero_end = page + kPageSize;
+    }
+
+    chunk_start = chunk_end;
+  }
+  zero_pending_range();
+}
+
+void Migrator::transmit_encoded(rt::TcpConn *c, std::span<const iovec> task,
+                                StripeEncoder *encoder) {
+  // The last iovec is the heap stripe; the preceding ones form its header.
+  BUG_ON(c->WritevFull(task.first(task.size() - 1), /* nt = */ false,
+                       /* poll = */ true) < 0);
+
+  auto start = reinterpret_cast<uint64_t>(task.back().iov_base);
+  auto end = start + task.back().iov_len;
+  for (auto chunk_start = start; chunk_start < end;) {
+    auto chunk_end = next_chunk_end(chunk_start, end);
+    EncodedChunkHeader hdr{.payload_len = 0, .zero_pages = 0,
+                           .compressed = false};
+
+    if constexpr (kEnableZeroPageElision) {
+      // Only pages that fully lie within the stripe can be elided.
+      auto chunk_base = chunk_start & ~(kEncodedChunkSize - 1);
+      for (uint32_t i = 0; i < kEncodedChunkSize / kPageSize; i++) {
+        auto page = chunk_base + i * kPageSize;
+        if (page >= chunk_start && page + kPageSize <= chunk_end &&
+            is_zero_page(reinterpret_cast<const std::byte *>(page))) {
+          hdr.zero_pages |= (1 << i);
+        }
+      }
+    }
+
+    iovec iovecs[1 + kEncodedChunkSize / kPageSize];
+    uint32_t num_iovecs = 1;
+    uint64_t raw_len = 0;
+    iovecs[0] = {&hdr, sizeof(hdr)};
+    for_each_chunk_run(chunk_start, chunk_end, hdr.zero_pages,
+                       [&](uint64_t run_start, uint64_t run_len) {
+                         iovecs[num_iovecs++] = {
+                             reinterpret_cast<void *>(run_start), run_len};
+                         raw_len += run_len;
+                       });
+
+    if constexpr (kEnableCompression) {
+      if (raw_len) {
+        const std::byte *src;
+        if (num_iovecs == 2) {
+          src = reinterpret_cast<const std::byte *>(iovecs[1].iov_base);
+        } else {
+          auto *gathered = encoder->gather_buf.get();
+          for (uint32_t i = 1; i < num_iovecs; i++) {
+            memcpy(gathered, iovecs[i].iov_base, iovecs[i].iov_len);
+            gathered += iovecs[i].iov_len;
+          }
+          src = encoder->gather_buf.get();
+        }
+        // Only bother the receiver with decompression if it saves >= 1/8.
+        hdr.payload_len = encoder->lz4.compress(
+            src, raw_len, encoder->compression_buf.get(), raw_len * 7 / 8);
+        if (hdr.payload_len) {
+          hdr.compressed = true;
+          const iovec compressed_iovecs[] = {
+              {&hdr, sizeof(hdr)},
+              {encoder->compression_buf.get(), hdr.payload_len}};
+          BUG_ON(c->WritevFull(std::span(compressed_iovecs), /* nt = */ false,
+                               /* poll = */ true) < 0);
+          chunk_start = chunk_end;
+          continue;
+        }
+      }
+    }
+
+    hdr.payload_len = raw_len;
+    BUG_ON(c->WritevFull(std::span<const iovec>(iovecs, num_iovecs),
+                         /* nt = */ true, /* poll = */ true) < 0);
+    chunk_start = chunk_end;
+  }
+}
+
 inline void Migrator::handle_load(rt::TcpConn *c) {
   Caladan::PreemptGuard g;
 
@@ -168,7 +384,10 @@ void Migrator::run_background_loop() {
           }
           switch (type) {
             case kCopyProclet:
-              handle_copy_proclet(c);
+              handle_copy_proclet(c, /* encoded = */ false);
+              break;
+            case kCopyEncodedProclet:
+              handle_copy_proclet(c, /* encoded = */ true);
               break;
             case kMigrate:
               handle_load(c);
@@ -211,7 +430,8 @@ inline void throttle(uint64_t len, uint64_t real_us) {
   }
 }
 
-void Migrator::transmit_proclet(rt::TcpConn *c, ProcletHeader *proclet_header) {
+uint64_t Migrator::transmit_proclet(rt::TcpConn *c,
+                                   ProcletHeader *proclet_header) {
   constexpr bool kMonitorTime =
       (kEnableLogging || kMigrationThrottleGBs > 0 || kMigrationDelayUs);
   [[maybe_unused]] uint64_t t0, t1;
@@ -220,7 +440,7 @@ void Migrator::transmit_proclet(rt::TcpConn *c, ProcletHeader *proclet_header) {
     t0 = microtime();
   }
 
-  uint8_t type = kCopyProclet;
+  uint8_t type = kEncodeStripes ? kCopyEncodedProclet : kCopyProclet;
   auto start_addr = reinterpret_cast<uint64_t>(proclet_header->copy_start);
   auto len = (reinterpret_cast<uint64_t>(proclet_header->slab.get_base()) -
               start_addr) +
@@ -242,8 +462,11 @@ void Migrator::transmit_proclet(rt::TcpConn *c, ProcletHeader *proclet_header) {
         {reinterpret_cast<std::byte *>(req_start_addrs[i]), req_lens[i]}};
     if (i < PressureHandler::kNumAuxHandlers) {
       // Dispatch to aux handler.
-      get_runtime()->pressure_handler()->dispatch_aux_tcp_task(i,
-                                                               std::move(task));
+      get_runtime()->pressure_handler()->dispatch_aux_tcp_task(
+          i, std::move(task), /* encode = */ kEncodeStripes);
+    } else if constexpr (kEncodeStripes) {
+      // Execute the task itself.
+      transmit_encoded(c, task, &encoder_);
     } else {
       // Execute the task itself.
       BUG_ON(c->WritevFull(std::span<const iovec>(task), /* nt = */ true,
@@ -282,6 +505,242 @@ void Migrator::transmit_proclet(rt::TcpConn *c, ProcletHeader *proclet_header) {
                << get_runtime()->proclet_manager()->get_num_present_proclets()
                << std::endl;
   }
+
+  return len;
+}
+
+static const MD5Val &self_md5() {
+  static const auto md5 = get_self_md5();
+  return md5;
+}
+
+static bool pwrite_full(int fd, const std::byte *buf, uint64_t len,
+                        uint64_t offset) {
+  while (len) {
+    auto ret = pwrite(fd, buf, len, offset);
+    if (unlikely(ret <= 0)) {
+      return false;
+    }
+    buf += ret;
+    len -= ret;
+    offset += ret;
+  }
+  return true;
+}
+
+bool Migrator::save_proclet_snapshot(ProcletHeader *proclet_header,
+                                     const std::string &path) {
+  RuntimeSlabGuard guard;
+
+  // Blocked or sleeping threads cannot be persisted.
+  auto &time = proclet_header->time;
+  {
+    ScopedLock lock(&time.spin_);
+    if (unlikely(!time.entries_.empty())) {
+      return false;
+    }
+  }
+  if (unlikely(!proclet_header->blocked_syncer.get_all().empty())) {
+    return false;
+  }
+
+  auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (unlikely(fd < 0)) {
+    return false;
+  }
+
+  auto *base = reinterpret_cast<std::byte *>(proclet_header);
+  auto &slab = proclet_header->slab;
+  auto heap_len = reinterpret_cast<std::byte *>(slab.get_base()) - base +
+                  slab.get_usage();
+  auto num_pages = div_round_up_unchecked(heap_len, kPageSize);
+
+  auto page_buf = std::make_unique<std::byte[]>(kSnapshotHeapOffset);
+  auto *snapshot_header = reinterpret_cast<ProcletSnapshotHeader *>(
+      page_buf.get());
+  snapshot_header->magic = ProcletSnapshotHeader::kMagic;
+  snapshot_header->md5 = self_md5();
+  snapshot_header->migratable = proclet_header->migratable;
+  snapshot_header->id = to_proclet_id(proclet_header);
+  snapshot_header->capacity = proclet_header->capacity;
+  snapshot_header->heap_len = heap_len;
+  snapshot_header->logical_tsc =
+      static_cast<int64_t>(rdtscp(nullptr) - start_tsc) + time.offset_tsc_;
+  bool ok = pwrite_full(fd, page_buf.get(), kSnapshotHeapOffset, 0);
+
+  // Like migration, the header fields before copy_start are not persisted. The
+  // header spans several pages with many cores, so zero all of them and copy
+  // only the tail of the last one.
+  uint64_t copy_start_off =
+      reinterpret_cast<std::byte *>(proclet_header->copy_start) - base;
+  auto num_head_pages = div_round_up_unchecked(copy_start_off, kPageSize);
+  BUG_ON(num_head_pages > num_pages);
+  auto head_len = num_head_pages * kPageSize;
+  auto head_buf = std::make_unique<std::byte[]>(head_len);
+  std::memset(head_buf.get(), 0, copy_start_off);
+  std::memcpy(head_buf.get() + copy_start_off, base + copy_start_off,
+              head_len - copy_start_off);
+  ok &= pwrite_full(fd, head_buf.get(), head_len, kSnapshotHeapOffset);
+
+  // Stream the rest straight from the heap, leaving holes for zero pages.
+  uint64_t run_start = num_head_pages;
+  for (uint64_t i = num_head_pages; ok && i <= num_pages; i++) {
+    if (i == num_pages || is_zero_page(base + i * kPageSize)) {
+      if (run_start < i) {
+        ok &= pwrite_full(fd, base + run_start * kPageSize,
+                          (i - run_start) * kPageSize,
+                          kSnapshotHeapOffset + run_start * kPageSize);
+      }
+      run_start = i + 1;
+    }
+  }
+
+  ok &= (ftruncate(fd, kSnapshotHeapOffset + num_pages * kPageSize) == 0);
+  ok &= (fdatasync(fd) == 0);
+  // Don't let the written pages linger in the page cache.
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+  return ok;
+}
+
+void Migrator::map_proclet_snapshot(
+    int fd, const ProcletSnapshotHeader &snapshot_header, bool migratable) {
+  // Pages are faulted in lazily from the file and become anonymous on write.
+  auto *base = to_proclet_base(snapshot_header.id);
+  auto map_len =
+      div_round_up_unchecked(snapshot_header.heap_len, kPageSize) * kPageSize;
+  auto mmap_addr = mmap(base, map_len, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_FIXED, fd, kSnapshotHeapOffset);
+  BUG_ON(mmap_addr != base);
+  BUG_ON(madvise(base, map_len, MADV_DONTDUMP) == -1);
+  ProcletManager::bind_to_local_socket(base, map_len);
+
+  auto *proclet_header = reinterpret_cast<ProcletHeader *>(base);
+  get_runtime()->proclet_manager()->setup(proclet_header,
+                                          snapshot_header.capacity, migratable,
+                                          /* from_migration = */ true);
+  std::construct_at(&proclet_header->rcu_lock);
+  std::construct_at(&proclet_header->slab_ref_cnt);
+  auto *slab = &proclet_header->slab;
+  nu::SlabAllocator::register_slab_by_id(slab, slab->get_id());
+
+  auto &time = proclet_header->time;
+  time.offset_tsc_ =
+      snapshot_header.logical_tsc - (rdtscp(nullptr) - start_tsc);
+}
+
+ProcletID Migrator::restore_proclet_snapshot(const std::string &path,
+                                             bool pinned) {
+  RuntimeSlabGuard guard;
+
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (unlikely(fd < 0)) {
+    return 0;
+  }
+
+  ProcletSnapshotHeader snapshot_header;
+  auto ret = pread(fd, &snapshot_header, sizeof(snapshot_header), 0);
+  // The heap holds code pointers, so it is only valid for the same binary.
+  if (unlikely(ret != sizeof(snapshot_header) ||
+               snapshot_header.magic != ProcletSnapshotHeader::kMagic ||
+               snapshot_header.md5 != self_md5())) {
+    close(fd);
+    return 0;
+  }
+
+  auto id = snapshot_header.id;
+  auto optional = get_runtime()->controller_client()->allocate_proclet(
+      snapshot_header.capacity, get_cfg_ip(), id);
+  if (unlikely(!optional)) {
+    close(fd);
+    return 0;
+  }
+  get_runtime()->rpc_client_mgr()->update_cache(id, get_cfg_ip());
+
+  map_proclet_snapshot(fd, snapshot_header, /* migratable = */ !pinned);
+  close(fd);
+
+  auto *proclet_header = reinterpret_cast<ProcletHeader *>(to_proclet_base(id));
+  proclet_header->ref_cnt = kProcletInitialWeight;
+  get_runtime()->proclet_manager()->insert(proclet_header);
+  return id;
+}
+
+std::string Migrator::get_spill_path(ProcletHeader *proclet_header) {
+  return std::string(kSpillDir) + "/nu_spill." + std::to_string(getpid()) +
+         "." + std::to_string(to_proclet_id(proclet_header));
+}
+
+bool Migrator::spill_proclet(ProcletHeader *proclet_header) {
+  if (unlikely(!try_mark_proclet_migrating(proclet_header))) {
+    return false;
+  }
+
+  // Only idle proclets can be spilled, as there is no thread state to save.
+  bool idle = !proclet_header->thread_cnt.get() &&
+              !proclet_header->slab_ref_cnt.get();
+  auto path = get_spill_path(proclet_header);
+  if (unlikely(!idle || !save_proclet_snapshot(proclet_header, path))) {
+    unlink(path.c_str());
+    get_runtime()->proclet_manager()->insert(proclet_header);
+    proclet_header->cond_var.signal_all();
+    return false;
+  }
+
+  ScopedLock l(&proclet_header->migration_spin());
+  get_runtime()->proclet_manager()->cleanup(proclet_header,
+                                            /* for_migration = */ true);
+  proclet_header->status() = kSpilled;
+  return true;
+}
+
+uint32_t Migrator::spill(
+    std::span<const std::pair<ProcletMigrationTask, Resource>> tasks) {
+  std::vector<std::pair<float, ProcletHeader *>> cold_proclets;
+  for (auto &[task, resource] : tasks) {
+    if (resource.cores <= kSpillMaxCPULoad) {
+      cold_proclets.emplace_back(resource.cores, task.header);
+    }
+  }
+  std::stable_sort(
+      cold_proclets.begin(), cold_proclets.end(),
+      [](const auto &x, const auto &y) { return x.first < y.first; });
+
+  uint32_t num_spilled = 0;
+  for (auto [_, proclet_header] : cold_proclets) {
+    if (!get_runtime()->pressure_handler()->has_mem_pressure()) {
+      break;
+    }
+    num_spilled += spill_proclet(proclet_header);
+  }
+
+  if constexpr (kEnableLogging) {
+    std::cout << "Spill " << num_spilled << " proclets." << std::endl;
+  }
+  return num_spilled;
+}
+
+void Migrator::unspill_proclet(ProcletHeader *proclet_header) {
+  RuntimeSlabGuard guard;
+  ScopedLock l(&proclet_header->migration_spin());
+
+  if (unlikely(proclet_header->status() != kSpilled)) {
+    return;
+  }
+
+  auto path = get_spill_path(proclet_header);
+  auto fd = open(path.c_str(), O_RDONLY);
+  BUG_ON(fd < 0);
+  ProcletSnapshotHeader snapshot_header;
+  BUG_ON(pread(fd, &snapshot_header, sizeof(snapshot_header), 0) !=
+         sizeof(snapshot_header));
+  BUG_ON(snapshot_header.magic != ProcletSnapshotHeader::kMagic);
+  map_proclet_snapshot(fd, snapshot_header, snapshot_header.migratable);
+  // The mapping keeps the file alive until the heap is depopulated.
+  BUG_ON(unlink(path.c_str()) != 0);
+  close(fd);
+
+  get_runtime()->proclet_manager()->insert(proclet_header);
 }
 
 void Migrator::transmit_mutexes(rt::TcpConn *c, std::vector<Mutex *> mutexes) {
@@ -423,13 +882,16 @@ void Migrator::transmit_proclet_migration_tasks(
 
 void Migrator::update_proclet_location(rt::TcpConn *c,
                                        ProcletHeader *proclet_header) {
+  auto dest_ip = c->RemoteAddr().ip;
   get_runtime()->controller_client()->update_location(
-      to_proclet_id(proclet_header), c->RemoteAddr().ip);
+      to_proclet_id(proclet_header), dest_ip);
+  proclet_header->tombstone() = dest_ip;
 }
 
-void Migrator::transmit(rt::TcpConn *c, ProcletHeader *proclet_header,
-                        struct list_head *paused_ths_list) {
-  transmit_proclet(c, proclet_header);
+MigrationSample Migrator::transmit(rt::TcpConn *c,
+                                   ProcletHeader *proclet_header,
+                                   struct list_head *paused_ths_list) {
+  auto len = transmit_proclet(c, proclet_header);
 
   std::vector<thread_t *> ready_threads;
   std::vector<Mutex *> mutexes;
@@ -461,6 +923,12 @@ void Migrator::transmit(rt::TcpConn *c, ProcletHeader *proclet_header,
   transmit_threads(c, ready_threads);
 
   update_proclet_location(c, proclet_header);
+
+  // The same feature that Utility queries the cost model with.
+  auto num_threads = std::max(proclet_header->thread_cnt.get(), int64_t{0});
+  return MigrationSample{.mem_size = len,
+                         .num_threads = static_cast<uint32_t>(num_threads),
+                         .time_us = 0};
 }
 
 bool Migrator::try_mark_proclet_migrating(ProcletHeader *proclet_header) {
@@ -525,6 +993,11 @@ uint32_t Migrator::migrate(
             has_mem_pressure, it->second);
     auto dest_ip = dest_guard.get_ip();
     if (unlikely(!dest_guard || congested_dests.contains(dest_ip))) {
+      if constexpr (kEnableSpilling) {
+        if (has_mem_pressure) {
+          return (it - tasks.begin()) + spill(std::span(it, tasks.end()));
+        }
+      }
       break;
     }
 
@@ -629,11 +1102,14 @@ uint32_t Migrator::__migrate(const NodeGuard &dest_guard, bool mem_pressure,
       aux_handlers_enable_polling(dest_guard.get_ip());
     }
 
+    auto start_us = microtime();
     pause_migrating_threads(proclet_header);
     {
       ScopedLock l(&proclet_header->migration_spin());
 
-      transmit(conn, proclet_header, &all_migrating_ths);
+      auto sample = transmit(conn, proclet_header, &all_migrating_ths);
+      sample.time_us = microtime() - start_us;
+      cost_model_.record(dest_guard.get_ip(), sample);
       gc_migrated_threads();
       proclet_header->status() = kCleaning;
     }
@@ -665,8 +1141,8 @@ bool Migrator::load_proclet(rt::TcpConn *c, ProcletHeader *proclet_header,
   if (unlikely(type == kSkipProclet)) {
     return false;
   }
-  BUG_ON(type != kCopyProclet);
-  handle_copy_proclet(c);
+  BUG_ON(type != kCopyProclet && type != kCopyEncodedProclet);
+  handle_copy_proclet(c, /* encoded = */ type == kCopyEncodedProclet);
 
   get_runtime()->proclet_manager()->setup(proclet_header, capacity,
                                           /* migratable = */ false,
@@ -859,18 +1335,21 @@ Migrator::load_proclet_migration_tasks(rt::TcpConn *c) {
 }
 
 void Migrator::populate_proclets(std::vector<ProcletMigrationTask> &tasks) {
-  for (auto &[header, _, size] : tasks) {
+  for (auto &[header, capacity, size] : tasks) {
     ScopedLock l(&header->migration_spin());
 
     if (unlikely(header->status() == kCleaning)) {
       std::destroy_at(&header->slab);
     }
     header->status() = kPopulating;
-    header->populate_size = size;
+    // Prefaults whole huge pages before the heap arrives.
+    header->populate_size =
+        ProcletManager::round_to_heap_pages(size, capacity);
   }
 
   rt::Spawn([tasks] {
-    for (auto &[header, _, size] : tasks) {
+    for (auto &task : tasks) {
+      auto *header = task.header;
       if (load_acquire(&header->status()) == kPopulating) {
         ScopedLock l(&header->migration_spin());
 
@@ -878,7 +1357,8 @@ void Migrator::populate_proclets(std::vector<ProcletMigrationTask> &tasks) {
           if (unlikely(get_runtime()->pressure_handler()->has_mem_pressure())) {
             break;
           }
-          get_runtime()->proclet_manager()->madvise_populate(header, size);
+          get_runtime()->proclet_manager()->madvise_populate(
+              header, header->populate_size);
         }
       }
     }
@@ -949,38 +1429,50 @@ void Migrator::reserve_conns(uint32_t dest_server_ip) {
   }
 }
 
-void Migrator::forward_to_original_server(
+void Migrator::return_from_migrated_thread(
     RPCReturnCode rc, RPCReturner *returner, uint64_t payload_len,
     const void *payload, ArchivePool<>::IASStream *ia_sstream) {
   RuntimeSlabGuard guard;
 
-  auto req_buf_len = sizeof(RPCReqForward) + payload_len;
-  auto req_buf = std::make_unique_for_overwrite<std::byte[]>(req_buf_len);
-  auto *req = reinterpret_cast<RPCReqForward *>(req_buf.get());
-  std::construct_at(req);
-  req->rc = rc;
-  req->returner = *returner;
-  req->gc_ia_sstream = ia_sstream;
-  req->payload_len = payload_len;
-  memcpy(req->payload, payload, payload_len);
-  auto req_span = std::span(req_buf.get(), req_buf_len);
+  // Respond to the client directly rather than through the original server.
   RPCReturnBuffer return_buf;
-  auto *client =
+  auto client_ip = returner->get_client_ip();
+  if (client_ip == get_cfg_ip()) {
+    auto span =
+        std::span(reinterpret_cast<const std::byte *>(payload), payload_len);
+    RPCClient::CompleteDirectly(returner->get_completion_data(), rc, span);
+  } else {
+    auto req_buf_len = sizeof(RPCReqDirectReturn) + payload_len;
+    auto req_buf = std::make_unique_for_overwrite<std::byte[]>(req_buf_len);
+    auto *req = reinterpret_cast<RPCReqDirectReturn *>(req_buf.get());
+    std::construct_at(req);
+    req->rc = rc;
+    req->completion_data = returner->get_completion_data();
+    req->payload_len = payload_len;
+    memcpy(req->payload, payload, payload_len);
+    auto req_span = std::span(req_buf.get(), req_buf_len);
+    auto *client = get_runtime()->rpc_client_mgr()->get_by_ip(client_ip);
+    BUG_ON(client->Call(req_span, &return_buf) != kOk);
+  }
+
+  // The original server only needs to release the resources of the call.
+  RPCReqForward forward_req;
+  forward_req.returner = *returner;
+  forward_req.gc_ia_sstream = ia_sstream;
+  auto forward_req_span = to_span(forward_req);
+  auto *original_server =
       get_runtime()->rpc_client_mgr()->get_by_ip(thread_get_creator_ip());
-  BUG_ON(client->Call(req_span, &return_buf) != kOk);
+  BUG_ON(original_server->Call(forward_req_span, &return_buf) != kOk);
 }
 
-void Migrator::forward_to_client(RPCReqForward &req) {
-  if (req.payload_len) {
-    auto payload_buf =
-        std::make_unique_for_overwrite<std::byte[]>(req.payload_len);
-    memcpy(payload_buf.get(), req.payload, req.payload_len);
-    auto span = std::span(payload_buf.get(), req.payload_len);
-    req.returner.Return(req.rc, span,
-                        [payload_buf = std::move(payload_buf)] {});
-  } else {
-    req.returner.Return(req.rc);
-  }
+void Migrator::direct_return(RPCReqDirectReturn &req) {
+  auto span = std::span(reinterpret_cast<const std::byte *>(req.payload),
+                        req.payload_len);
+  RPCClient::CompleteDirectly(req.completion_data, req.rc, span);
+}
+
+void Migrator::finish_forwarded_call(RPCReqForward &req) {
+  req.returner.Return(kDirectlyReturned);
   delete (req.gc_ia_sstream->ss.span().data() - sizeof(RPCReqType));
   get_runtime()->archive_pool()->put_ia_sstream(req.gc_ia_sstream);
   get_runtime()->rpc_server()->dec_ref_cnt();
@@ -1002,7 +1494,8 @@ retry:
   auto rc = rpc_client->Call(req_span, &unused_buf);
 
   if (unlikely(rc == kErrWrongClient)) {
-    get_runtime()->rpc_client_mgr()->invalidate_cache(dest_id, rpc_client);
+    get_runtime()->rpc_client_mgr()->handle_wrong_client(dest_id, rpc_client,
+                                                         unused_buf);
     goto retry;
   }
 
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <set>
 #include <type_traits>
 
 #include <sync.h>
@@ -11,6 +14,7 @@
 #include "nu/migrator.hpp"
 #include "nu/pressure_handler.hpp"
 #include "nu/utils/caladan.hpp"
+#include "nu/utils/scoped_lock.hpp"
 
 constexpr static bool kEnableLogging = false;
 
@@ -22,8 +26,8 @@ PressureHandler::PressureHandler()
 
   update_th_ = rt::Thread([&] {
     while (!rt::access_once(done_)) {
-      timer_sleep_hp(kSortedProcletsUpdateIntervalMs * kOneMilliSecond);
-      update_sorted_proclets();
+      timer_sleep_hp(kCandidatesRefreshIntervalMs * kOneMilliSecond);
+      refresh_candidates();
     }
   });
 }
@@ -44,36 +48,93 @@ Utility::Utility() {}
 Utility::Utility(ProcletHeader *proclet_header, uint64_t mem_size,
                  float cpu_load) {
   header = proclet_header;
-  auto time = kFixedCostUs + (mem_size / (kNetBwGbps / 8.0f) / 1000.0f);
+  auto num_threads = std::max(proclet_header->thread_cnt.get(), int64_t{0});
+  auto time = get_runtime()->migrator()->cost_model().estimate_us(
+      mem_size, num_threads);
+  time = std::max(time, 1.0f);
 
   cpu_pressure_util = cpu_load / time;
   mem_pressure_util = mem_size / time;
 }
 
-void PressureHandler::update_sorted_proclets() {
+int8_t PressureHandler::to_util_bucket(float util) {
+  if (unlikely(util <= 0)) {
+    return 0;
+  }
+  auto bucket = std::ilogb(util) - kMinUtilExp;
+  return std::clamp(bucket, 0, static_cast<int>(kNumUtilBuckets) - 1);
+}
+
+void PressureHandler::add_candidate(ProcletHeader *header) {
+  Utility u(header, header->total_mem_size(), header->cpu_load.get_load());
+  auto mem_bucket = to_util_bucket(u.mem_pressure_util);
+  auto cpu_bucket = to_util_bucket(u.cpu_pressure_util);
+
+  RuntimeSlabGuard guard;
+  ScopedLock lock(&candidates_spin_);
+  header->util_update_tsc = rdtsc();
+  header->mem_util_bucket = mem_bucket;
+  header->cpu_util_bucket = cpu_bucket;
+  mem_util_buckets_[mem_bucket].insert(header);
+  cpu_util_buckets_[cpu_bucket].insert(header);
+}
+
+void PressureHandler::remove_candidate(ProcletHeader *header) {
+  ScopedLock lock(&candidates_spin_);
+  if (likely(header->mem_util_bucket != ProcletHeader::kNoUtilBucket)) {
+    mem_util_buckets_[header->mem_util_bucket].erase(header);
+    cpu_util_buckets_[header->cpu_util_bucket].erase(header);
+    header->mem_util_bucket = ProcletHeader::kNoUtilBucket;
+    header->cpu_util_bucket = ProcletHeader::kNoUtilBucket;
+  }
+}
+
+void PressureHandler::rebucket_candidate(ProcletHeader *header,
+                                         const Utility &u) {
+  auto mem_bucket = to_util_bucket(u.mem_pressure_util);
+  auto cpu_bucket = to_util_bucket(u.cpu_pressure_util);
+  if (rt::access_once(header->mem_util_bucket) == mem_bucket &&
+      rt::access_once(header->cpu_util_bucket) == cpu_bucket) {
+    return;
+  }
+
+  RuntimeSlabGuard guard;
+  ScopedLock lock(&candidates_spin_);
+  // Lost the race against remove_candidate().
+  if (unlikely(header->mem_util_bucket == ProcletHeader::kNoUtilBucket)) {
+    return;
+  }
+  if (header->mem_util_bucket != mem_bucket) {
+    mem_util_buckets_[header->mem_util_bucket].erase(header);
+    mem_util_buckets_[mem_bucket].insert(header);
+    header->mem_util_bucket = mem_bucket;
+  }
+  if (header->cpu_util_bucket != cpu_bucket) {
+    cpu_util_buckets_[header->cpu_util_bucket].erase(header);
+    cpu_util_buckets_[cpu_bucket].insert(header);
+    header->cpu_util_bucket = cpu_bucket;
+  }
+}
+
+void PressureHandler::refresh_candidates() {
   CPULoad::flush_all();
 
-  auto new_mem_pressure_sorted_proclets =
-      std::make_shared<decltype(mem_pressure_sorted_proclets_)::element_type>();
-  auto new_cpu_pressure_sorted_proclets =
-      std::make_shared<decltype(cpu_pressure_sorted_proclets_)::element_type>();
+  auto now_tsc = rdtsc();
+  auto stale_tsc = now_tsc - kCandidateUpdateIntervalUs * cycles_per_us;
   auto all_proclets = get_runtime()->proclet_manager()->get_all_proclets();
 
   auto used_budget = 0;
   for (auto *proclet_base : all_proclets) {
     auto *proclet_header = reinterpret_cast<ProcletHeader *>(proclet_base);
-    auto optional_info = get_runtime()->proclet_manager()->get_proclet_info(
-        proclet_header, std::function([](const ProcletHeader *header) {
-          return std::make_tuple(header->migratable, header->total_mem_size(),
-                                 header->cpu_load.get_load());
-        }));
-
-    if (likely(optional_info)) {
-      auto [migratable, mem_size, cpu_load] = *optional_info;
-      if (migratable) {
-        Utility u(proclet_header, mem_size, cpu_load);
-        new_cpu_pressure_sorted_proclets->insert(u);
-        new_mem_pressure_sorted_proclets->insert(u);
+    if (rt::access_once(proclet_header->util_update_tsc) < stale_tsc) {
+      auto optional_u = get_runtime()->proclet_manager()->get_proclet_info(
+          proclet_header, [&](const ProcletHeader *header) {
+            return Utility(proclet_header, header->total_mem_size(),
+                           header->cpu_load.get_load());
+          });
+      if (likely(optional_u)) {
+        proclet_header->util_update_tsc = now_tsc;
+        rebucket_candidate(proclet_header, *optional_u);
       }
     }
 
@@ -82,15 +143,6 @@ void PressureHandler::update_sorted_proclets() {
       rt::Yield();
     }
   }
-
-  {
-    Caladan::PreemptGuard g;
-
-    std::atomic_exchange(&cpu_pressure_sorted_proclets_,
-                         new_cpu_pressure_sorted_proclets);
-    std::atomic_exchange(&mem_pressure_sorted_proclets_,
-                         new_mem_pressure_sorted_proclets);
-  }
 }
 
 void PressureHandler::register_handlers() {
@@ -175,12 +227,13 @@ void PressureHandler::update_aux_handler_state(uint32_t handler_id,
 }
 
 void PressureHandler::dispatch_aux_tcp_task(
-    uint32_t handler_id, std::vector<iovec> &&tcp_write_task) {
+    uint32_t handler_id, std::vector<iovec> &&tcp_write_task, bool encode) {
   auto &state = aux_handler_states_[handler_id];
   while (rt::access_once(state.task_pending)) {
     get_runtime()->caladan()->unblock_and_relax();
   }
   state.tcp_write_task = std::move(tcp_write_task);
+  state.encode = encode;
   store_release(&state.task_pending, true);
 }
 
@@ -200,6 +253,9 @@ void PressureHandler::__aux_handler(AuxHandlerState *state) {
       if (state->pause) {
         pause_migrating_ths_aux();
         store_release(&state->pause, false);
+      } else if (state->encode) {
+        Migrator::transmit_encoded(state->conn.get_tcp_conn(),
+                                   state->tcp_write_task, &state->encoder);
       } else {
         auto *c = state->conn.get_tcp_conn();
         BUG_ON(c->WritevFull(std::span<const iovec>(state->tcp_write_task),
@@ -240,11 +296,11 @@ PressureHandler::pick_tasks(uint32_t min_num_proclets, uint32_t min_mem_mbs) {
 
   auto pick_fn = [&](ProcletHeader *header) {
     auto optional = get_runtime()->proclet_manager()->get_proclet_info(
-        header, std::function([&](const ProcletHeader *header) {
+        header, [&](const ProcletHeader *header) {
           return std::make_tuple(header->migratable, header->capacity,
                                  header->heap_size(), header->total_mem_size(),
                                  header->cpu_load.get_load());
-        }));
+        });
     if (likely(optional)) {
       auto &[migratable, capacity, heap_size, mem_size, cpu_load] = *optional;
       if (likely(migratable && !dedupper.contains(header))) {
@@ -258,19 +314,20 @@ PressureHandler::pick_tasks(uint32_t min_num_proclets, uint32_t min_mem_mbs) {
                 (picked_tasks.size() >= min_num_proclets));
       }
     }
-
-    return optional.has_value();
   };
 
-  auto traverse_fn = [&]<typename T>(T &&sorted_proclets) {
-    if (sorted_proclets) {
-      auto iter = sorted_proclets->begin();
-      while (iter != sorted_proclets->end() && !done) {
-        if (pick_fn(iter->header)) {
-          ++iter;
-        } else {
-          iter = sorted_proclets->erase(iter);
-        }
+  // Walks the buckets from the highest utility downwards and stops as soon as
+  // enough proclets have been picked.
+  auto traverse_fn = [&](UtilBuckets &buckets) {
+    std::vector<ProcletHeader *> candidates;
+    for (int i = kNumUtilBuckets - 1; i >= 0 && !done; i--) {
+      {
+        ScopedLock lock(&candidates_spin_);
+        candidates.assign(buckets[i].begin(), buckets[i].end());
+      }
+      for (auto iter = candidates.begin(); iter != candidates.end() && !done;
+           ++iter) {
+        pick_fn(*iter);
       }
     }
   };
@@ -278,19 +335,9 @@ PressureHandler::pick_tasks(uint32_t min_num_proclets, uint32_t min_mem_mbs) {
   bool cpu_pressure = min_num_proclets;
   assert_preempt_disabled();
   if (cpu_pressure) {
-    traverse_fn(std::atomic_load(&cpu_pressure_sorted_proclets_));
+    traverse_fn(cpu_util_buckets_);
   } else {
-    traverse_fn(std::atomic_load(&mem_pressure_sorted_proclets_));
-  }
-
-  if (unlikely(!done)) {
-    CPULoad::flush_all();
-    auto all_proclets = get_runtime()->proclet_manager()->get_all_proclets();
-    auto iter = all_proclets.begin();
-    while (iter != all_proclets.end() && !done) {
-      auto *header = reinterpret_cast<ProcletHeader *>(*(iter++));
-      pick_fn(header);
-    }
+    traverse_fn(mem_util_buckets_);
   }
 
   return picked_tasks;
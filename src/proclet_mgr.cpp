@@ -1,22 +1,28 @@
 #include <asm/mman.h>
+#include <numaif.h>
 #include <sys/mman.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdint>
 #include <functional>
 #include <memory>
 
 extern "C" {
 #include <base/assert.h>
+#include <runtime/runtime.h>
 #include <runtime/thread.h>
 }
 
 #include "nu/runtime.hpp"
+#include "nu/pressure_handler.hpp"
 #include "nu/proclet_mgr.hpp"
 
 namespace nu {
 
 uint8_t proclet_statuses[kMaxNumProclets];
 SpinLock proclet_migration_spin[kMaxNumProclets];
+NodeIP proclet_tombstones[kMaxNumProclets];
 
 ProcletManager::ProcletManager() {
   num_present_proclets_ = 0;
@@ -30,9 +36,28 @@ ProcletManager::ProcletManager() {
     BUG_ON(mmap_addr != proclet_base);
     auto rc = madvise(proclet_base, kMaxProcletHeapSize, MADV_DONTDUMP);
     BUG_ON(rc == -1);
+    bind_to_local_socket(proclet_base, kMaxProcletHeapSize);
+    enable_huge_pages(proclet_base, kMaxProcletHeapSize);
   }
 }
 
+void ProcletManager::enable_huge_pages(void *addr, uint64_t len) {
+  if constexpr (kEnableHugePages) {
+    auto rc = madvise(addr, len, MADV_HUGEPAGE);
+    BUG_ON(rc == -1);
+  }
+}
+
+void ProcletManager::bind_to_local_socket(void *addr, uint64_t len) {
+  // All kthreads run on the runtime's socket, so keep the heaps next to them
+  // rather than wherever the first touch happens to fault. Preferred rather
+  // than strict, so that a full socket spills over instead of OOMing.
+  unsigned long nodemask = 1UL << runtime_socket();
+  auto rc = mbind(addr, len, MPOL_PREFERRED, &nodemask,
+                  sizeof(nodemask) * 8, /* flags = */ 0);
+  BUG_ON(rc == -1);
+}
+
 void ProcletManager::madvise_populate(void *proclet_base,
                                       uint64_t populate_len) {
   populate_len = ((populate_len - 1) / kPageSize + 1) * kPageSize;
@@ -53,7 +78,10 @@ void ProcletManager::cleanup(void *proclet_base, bool for_migration) {
   std::destroy_at(&proclet_header->slab);
 
   bool defer = !for_migration;
-  depopulate(proclet_base, proclet_header->heap_size(), defer);
+  // Partially freeing a huge page would split it.
+  auto size = round_to_heap_pages(proclet_header->heap_size(),
+                                  proclet_header->capacity);
+  depopulate(proclet_base, size, defer);
 }
 
 void ProcletManager::depopulate(void *proclet_base, uint64_t size, bool defer) {
@@ -61,14 +89,26 @@ void ProcletManager::depopulate(void *proclet_base, uint64_t size, bool defer) {
 
   if (defer) {
     // Try to keep the memory for future reuses.
-    BUG_ON(madvise(proclet_base, size, MADV_FREE) != 0);
-  } else {
-    // Release mem ASAP.
-    auto mmap_addr =
-        mmap(proclet_base, size, PROT_READ | PROT_WRITE,
-             MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE, -1, 0);
-    BUG_ON(mmap_addr != proclet_base);
+    if (likely(madvise(proclet_base, size, MADV_FREE) == 0)) {
+      return;
+    }
+    // Heaps restored from snapshots are file-backed, which MADV_FREE rejects.
+    BUG_ON(errno != EINVAL);
   }
+
+  // Release mem ASAP.
+  auto mmap_addr =
+      mmap(proclet_base, size, PROT_READ | PROT_WRITE,
+           MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE, -1, 0);
+  BUG_ON(mmap_addr != proclet_base);
+  // The new mapping comes with the default policies.
+  bind_to_local_socket(proclet_base, size);
+  enable_huge_pages(proclet_base, size);
+}
+
+uint64_t ProcletManager::round_to_heap_pages(uint64_t size, uint64_t capacity) {
+  return std::min(div_round_up_unchecked(size, kHeapPageSize) * kHeapPageSize,
+                  capacity);
 }
 
 void ProcletManager::setup(void *proclet_base, uint64_t capacity,
@@ -83,9 +123,13 @@ void ProcletManager::setup(void *proclet_base, uint64_t capacity,
   std::construct_at(&proclet_header->blocked_syncer);
   std::construct_at(&proclet_header->time);
   proclet_header->migratable = migratable;
+  proclet_header->util_update_tsc = 0;
+  proclet_header->mem_util_bucket = ProcletHeader::kNoUtilBucket;
+  proclet_header->cpu_util_bucket = ProcletHeader::kNoUtilBucket;
 
   if (!from_migration) {
-    proclet_header->ref_cnt = 1;
+    proclet_header->ref_cnt = kProcletInitialWeight;
+    std::construct_at(&proclet_header->rem_ptr_version, 0);
     std::construct_at(&proclet_header->rcu_lock);
     std::construct_at(&proclet_header->slab_ref_cnt);
     auto slab_region_size = capacity - sizeof(ProcletHeader);
@@ -94,6 +138,33 @@ void ProcletManager::setup(void *proclet_base, uint64_t capacity,
   }
 }
 
+void ProcletManager::insert(void *proclet_base) {
+  auto *proclet_header = reinterpret_cast<ProcletHeader *>(proclet_base);
+  {
+    ScopedLock lock(&spin_);
+    proclet_header->status() = kPresent;
+    proclet_header->tombstone() = 0;
+    num_present_proclets_++;
+    present_proclets_.push_back(proclet_base);
+  }
+  get_runtime()->pressure_handler()->add_candidate(proclet_header);
+}
+
+bool ProcletManager::__remove(void *proclet_base, ProcletStatus new_status) {
+  auto *proclet_header = reinterpret_cast<ProcletHeader *>(proclet_base);
+  {
+    ScopedLock lock(&spin_);
+    auto &status = proclet_header->status();
+    if (status != kPresent) {
+      return false;
+    }
+    num_present_proclets_--;
+    status = new_status;
+  }
+  get_runtime()->pressure_handler()->remove_candidate(proclet_header);
+  return true;
+}
+
 std::vector<void *> ProcletManager::get_all_proclets() {
   ScopedLock lock(&spin_);
   auto iter = present_proclets_.begin();
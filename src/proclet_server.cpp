@@ -39,8 +39,9 @@ void ProcletServer::parse_and_run_handler(std::span<std::byte> args,
   ref_cnt_.inc();
 
   auto *ia_sstream = get_runtime()->archive_pool()->get_ia_sstream();
-  auto &[args_ss, ia] = *ia_sstream;
+  auto &args_ss = ia_sstream->ss;
   args_ss.span({reinterpret_cast<char *>(args.data()), args.size()});
+  ia_sstream->bulk_cursor = args.data() + args.size();
 
   GenericHandler handler;
   ia_sstream->ia >> handler;
@@ -94,6 +94,26 @@ void RPCClientMgr::invalidate_cache(ProcletID proclet_id, RPCClient *old_client)
   }
 }
 
+void RPCClientMgr::handle_wrong_client(ProcletID proclet_id,
+                                       RPCClient *old_client,
+                                       const RPCReturnBuffer &return_buf) {
+  auto buf = return_buf.get_buf();
+  if (buf.size_bytes() == sizeof(NodeIP)) {
+    auto new_ip = *reinterpret_cast<const NodeIP *>(buf.data());
+    if (likely(new_ip != old_client->GetAddr().ip)) {
+      update_cache(proclet_id, new_ip);
+      return;
+    }
+  }
+  invalidate_cache(proclet_id, old_client);
+}
+
+void RPCClientMgr::update_cache(std::span<const ProcletLocation> locations) {
+  for (auto [proclet_id, ip] : locations) {
+    update_cache(proclet_id, ip);
+  }
+}
+
 void RPCClientMgr::update_cache(ProcletID proclet_id, NodeIP ip) {
   auto slab_id = to_slab_id(proclet_id);
   rt::MutexGuard g(&node_info_mutexes_[slab_id]);
@@ -25,9 +25,15 @@ void RPCServer::handler_fn(std::span<std::byte> args, RPCReturner *returner) {
       returner->Return(kOk);
       break;
     }
+    case kDirectReturn: {
+      auto &req = from_span<RPCReqDirectReturn>(args);
+      get_runtime()->migrator()->direct_return(req);
+      returner->Return(kOk);
+      break;
+    }
     case kForward: {
       auto &req = from_span<RPCReqForward>(args);
-      get_runtime()->migrator()->forward_to_client(req);
+      get_runtime()->migrator()->finish_forwarded_call(req);
       returner->Return(kOk);
       break;
     }
@@ -48,8 +54,8 @@ void RPCServer::handler_fn(std::span<std::byte> args, RPCReturner *returner) {
     }
     case kAllocateProclet: {
       auto &req = from_span<RPCReqAllocateProclet>(args);
-      auto resp =
-          get_runtime()->controller_server()->handle_allocate_proclet(req);
+      auto resp = get_runtime()->controller_server()->handle_allocate_proclet(
+          req, returner->get_client_ip());
       auto span = to_span(*resp);
       returner->Return(kOk, span, [resp = std::move(resp)] {});
       break;
@@ -62,12 +68,19 @@ void RPCServer::handler_fn(std::span<std::byte> args, RPCReturner *returner) {
     }
     case kResolveProclet: {
       auto &req = from_span<RPCReqResolveProclet>(args);
-      auto resp =
-          get_runtime()->controller_server()->handle_resolve_proclet(req);
+      auto resp = get_runtime()->controller_server()->handle_resolve_proclet(
+          req, returner->get_client_ip());
       auto span = to_span(*resp);
       returner->Return(kOk, span, [resp = std::move(resp)] {});
       break;
     }
+    case kPushLocations: {
+      auto &req = from_span<RPCReqPushLocations>(args);
+      get_runtime()->rpc_client_mgr()->update_cache(
+          std::span(req.locations, req.num));
+      returner->Return(kOk);
+      break;
+    }
     case kDestroyLP: {
       auto &req = from_span<RPCReqDestroyLP>(args);
       get_runtime()->controller_server()->handle_destroy_lp(req);
@@ -81,8 +94,10 @@ void RPCServer::handler_fn(std::span<std::byte> args, RPCReturner *returner) {
       break;
     }
     case kGCStack: {
-      auto &req = from_span<RPCReqGCStack>(args);
-      get_runtime()->stack_manager()->put(req.stack);
+      auto &req = from_span<RPCReqGCStacks>(args);
+      for (uint32_t i = 0; i < req.num; i++) {
+        get_runtime()->stack_manager()->put(req.stacks[i]);
+      }
       returner->Return(kOk);
       break;
     }
@@ -104,6 +104,10 @@ void Runtime::reserve_conns(uint32_t ip) {
   rpc_client_mgr_->get_by_ip(ip);
 }
 
+void Runtime::unspill(ProcletHeader *proclet_header) {
+  migrator_->unspill_proclet(proclet_header);
+}
+
 void Runtime::send_rpc_resp_ok(ArchivePool<>::OASStream *oa_sstream,
                                ArchivePool<>::IASStream *ia_sstream,
                                RPCReturner *returner) {
@@ -118,14 +122,23 @@ void Runtime::send_rpc_resp_ok(ArchivePool<>::OASStream *oa_sstream,
       archive_pool_->put_oa_sstream(oa_sstream);
     });
   } else {
-    migrator_->forward_to_original_server(kOk, returner, len, data, ia_sstream);
+    migrator_->return_from_migrated_thread(kOk, returner, len, data,
+                                           ia_sstream);
     archive_pool_->put_oa_sstream(oa_sstream);
   }
 }
 
-void Runtime::send_rpc_resp_wrong_client(RPCReturner *returner) {
+void Runtime::send_rpc_resp_wrong_client(ProcletHeader *proclet_header,
+                                         RPCReturner *returner) {
   BUG_ON(caladan_->thread_has_been_migrated());
-  returner->Return(kErrWrongClient);
+  auto tombstone = Caladan::access_once(proclet_header->tombstone());
+  if (tombstone) {
+    auto new_ip = std::make_unique<NodeIP>(tombstone);
+    auto span = to_span(*new_ip);
+    returner->Return(kErrWrongClient, span, [new_ip = std::move(new_ip)] {});
+  } else {
+    returner->Return(kErrWrongClient);
+  }
 }
 
 void Runtime::shutdown(RPCReturner *returner) {
@@ -1,6 +1,12 @@
 #include <sys/mman.h>
 #include <algorithm>
 #include <cstring>
+#include <memory>
+#include <span>
+
+extern "C" {
+#include <runtime/timer.h>
+}
 
 #include "nu/stack_manager.hpp"
 #include "nu/runtime.hpp"
@@ -25,7 +31,8 @@ void mmap_all_stack_space() {
 StackManager::StackManager(VAddrRange stack_cluster)
     : range_(stack_cluster),
       cached_pool_([]() -> uint8_t * { BUG(); }, [](uint8_t *) {},
-                   kPerCoreCacheSize) {
+                   kPerCoreCacheSize),
+      done_(false) {
   mmap_all_stack_space();
 
   auto num_stacks = (stack_cluster.end - stack_cluster.start) / kStackSize;
@@ -34,6 +41,19 @@ StackManager::StackManager(VAddrRange stack_cluster)
     ptr += kStackSize;
     cached_pool_.put(ptr);
   }
+
+  gc_thread_ = rt::Thread([&] {
+    while (!rt::access_once(done_)) {
+      timer_sleep(kGCIntervalUs);
+      gc_pending();
+    }
+  });
+}
+
+StackManager::~StackManager() {
+  done_ = true;
+  barrier();
+  gc_thread_.Join();
 }
 
 uint8_t *StackManager::get() { return cached_pool_.get(); }
@@ -53,16 +73,60 @@ void StackManager::free(uint8_t *stack) {
   }
 }
 
+// Frees the stacks with one remapping per contiguous range.
+void StackManager::free_batch(std::vector<uint8_t *> &stacks) {
+  std::sort(stacks.begin(), stacks.end());
+  auto range_start = stacks.begin();
+  for (auto iter = stacks.begin(); iter != stacks.end(); iter++) {
+    auto next = iter + 1;
+    if (next == stacks.end() || *next != *iter + kStackSize) {
+      auto *start = *range_start - kStackSize;
+      auto len = *iter - start;
+      auto mmap_addr =
+          mmap(start, len, PROT_READ | PROT_WRITE,
+               MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE, -1, 0);
+      BUG_ON(mmap_addr != start);
+      range_start = next;
+    }
+  }
+}
+
+void StackManager::gc_pending() {
+  decltype(pending_gcs_) pending_gcs;
+  {
+    ScopedLock lock(&pending_gcs_spin_);
+    pending_gcs.swap(pending_gcs_);
+  }
+
+  for (auto &[ip, stacks] : pending_gcs) {
+    // The local mappings must be gone before the creator can reuse the stacks
+    // and migrate them back in.
+    free_batch(stacks);
+
+    auto *rpc_client = get_runtime()->rpc_client_mgr()->get_by_ip(ip);
+    for (std::size_t i = 0; i < stacks.size(); i += kMaxGCBatchSize) {
+      auto batch = std::span(stacks).subspan(
+          i, std::min<std::size_t>(kMaxGCBatchSize, stacks.size() - i));
+      auto req_buf_len = sizeof(RPCReqGCStacks) + batch.size_bytes();
+      auto req_buf = std::make_unique_for_overwrite<std::byte[]>(req_buf_len);
+      auto *req = reinterpret_cast<RPCReqGCStacks *>(req_buf.get());
+      std::construct_at(req);
+      req->num = batch.size();
+      std::memcpy(req->stacks, batch.data(), batch.size_bytes());
+      RPCReturnBuffer return_buf;
+      auto rc = rpc_client->Call(std::span(req_buf.get(), req_buf_len),
+                                 &return_buf);
+      BUG_ON(rc != kOk);
+    }
+  }
+}
+
 void StackManager::put(uint8_t *stack) {
   if (unlikely(not_owned(stack))) {
-    free(stack);
     auto ip = get_runtime()->caladan()->thread_get_creator_ip();
-    auto *rpc_client = get_runtime()->rpc_client_mgr()->get_by_ip(ip);
-    RPCReqGCStack rpc_req_gc_stack;
-    rpc_req_gc_stack.stack = stack;
-    RPCReturnBuffer return_buf;
-    auto rc = rpc_client->Call(to_span(rpc_req_gc_stack), &return_buf);
-    BUG_ON(rc != kOk);
+    RuntimeSlabGuard guard;
+    ScopedLock lock(&pending_gcs_spin_);
+    pending_gcs_[ip].push_back(stack);
     return;
   }
   cached_pool_.put(stack);
@@ -0,0 +1,49 @@
+#include "nu/utils/hdr_histogram.hpp"
+
+namespace nu {
+
+HdrHistogram::HdrHistogram() : cnts_(kNumBuckets) { reset(); }
+
+void HdrHistogram::reset() {
+  std::fill(cnts_.begin(), cnts_.end(), 0);
+  total_cnt_ = 0;
+  total_sum_ = 0;
+  max_ = 0;
+}
+
+void HdrHistogram::merge(const HdrHistogram &o) {
+  for (uint32_t i = 0; i < kNumBuckets; i++) {
+    cnts_[i] += o.cnts_[i];
+  }
+  total_cnt_ += o.total_cnt_;
+  total_sum_ += o.total_sum_;
+  max_ = std::max(max_, o.max_);
+}
+
+uint64_t HdrHistogram::highest_equivalent_val(uint32_t idx) {
+  if (idx < (1ULL << kSubBucketBits)) {
+    return idx;
+  }
+  uint32_t shift = idx / kHalfSubBucketCnt - 1;
+  uint64_t sub_bucket = idx - shift * kHalfSubBucketCnt;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+uint64_t HdrHistogram::percentile(double nth) const {
+  if (!total_cnt_) {
+    return 0;
+  }
+
+  auto target_cnt = static_cast<uint64_t>(nth / 100.0 * total_cnt_);
+  target_cnt = std::clamp(target_cnt, static_cast<uint64_t>(1), total_cnt_);
+  uint64_t cnt = 0;
+  for (uint32_t i = 0; i < kNumBuckets; i++) {
+    cnt += cnts_[i];
+    if (cnt >= target_cnt) {
+      return std::min(highest_equivalent_val(i), max_);
+    }
+  }
+  return max_;
+}
+
+}  // namespace nu
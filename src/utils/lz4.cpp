@@ -0,0 +1,168 @@
+#include <cstring>
+
+#include "nu/utils/lz4.hpp"
+
+namespace nu {
+
+static inline uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint8_t *write_len(uint8_t *op, uint64_t len) {
+  for (; len >= 255; len -= 255) {
+    *op++ = 255;
+  }
+  *op++ = len;
+  return op;
+}
+
+uint64_t LZ4::compress(const std::byte *src, uint64_t len, std::byte *dst,
+                       uint64_t dst_cap) {
+  auto *base = reinterpret_cast<const uint8_t *>(src);
+  auto *ip = base;
+  auto *anchor = base;
+  auto *iend = base + len;
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  auto *oend = op + dst_cap;
+
+  auto hash = [](uint32_t seq) {
+    return (seq * 2654435761U) >> (32 - kHashLog);
+  };
+
+  if (len > kMatchFindLimit) {
+    auto *mflimit = iend - kMatchFindLimit;
+    auto *matchlimit = iend - kLastLiterals;
+    memset(hash_table_, 0, sizeof(hash_table_));
+
+    while (ip < mflimit) {
+      auto seq = read32(ip);
+      auto h = hash(seq);
+      auto *ref = base + hash_table_[h];
+      hash_table_[h] = ip - base;
+
+      if (ref >= ip || read32(ref) != seq) {
+        // Skip faster through data that doesn't compress.
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      auto *match_end = ip + kMinMatch;
+      auto *ref_end = ref + kMinMatch;
+      while (match_end < matchlimit && *match_end == *ref_end) {
+        match_end++;
+        ref_end++;
+      }
+
+      uint64_t lit_len = ip - anchor;
+      uint64_t match_len = match_end - ip - kMinMatch;
+      if (op + 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1 >
+          oend) {
+        return 0;
+      }
+      auto *token = op++;
+      *token = (lit_len >= 15 ? 15 : lit_len) << 4;
+      if (lit_len >= 15) {
+        op = write_len(op, lit_len - 15);
+      }
+      memcpy(op, anchor, lit_len);
+      op += lit_len;
+      uint16_t offset = ip - ref;
+      *op++ = offset;
+      *op++ = offset >> 8;
+      *token |= (match_len >= 15 ? 15 : match_len);
+      if (match_len >= 15) {
+        op = write_len(op, match_len - 15);
+      }
+      anchor = ip = match_end;
+    }
+  }
+
+  uint64_t lit_len = iend - anchor;
+  if (op + 1 + lit_len / 255 + 1 + lit_len > oend) {
+    return 0;
+  }
+  *op++ = (lit_len >= 15 ? 15 : lit_len) << 4;
+  if (lit_len >= 15) {
+    op = write_len(op, lit_len - 15);
+  }
+  memcpy(op, anchor, lit_len);
+  op += lit_len;
+
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+int64_t LZ4::decompress(const std::byte *src, uint64_t len, std::byte *dst,
+                        uint64_t dst_cap) {
+  auto *ip = reinterpret_cast<const uint8_t *>(src);
+  auto *iend = ip + len;
+  auto *obase = reinterpret_cast<uint8_t *>(dst);
+  auto *op = obase;
+  auto *oend = op + dst_cap;
+
+  auto read_len = [&](uint64_t *l) {
+    uint8_t b;
+    do {
+      if (ip >= iend) {
+        return false;
+      }
+      b = *ip++;
+      *l += b;
+    } while (b == 255);
+    return true;
+  };
+
+  while (ip < iend) {
+    auto token = *ip++;
+
+    uint64_t lit_len = token >> 4;
+    if (lit_len == 15 && !read_len(&lit_len)) {
+      return -1;
+    }
+    if (lit_len > static_cast<uint64_t>(iend - ip) ||
+        lit_len > static_cast<uint64_t>(oend - op)) {
+      return -1;
+    }
+    memcpy(op, ip, lit_len);
+    ip += lit_len;
+    op += lit_len;
+    if (ip == iend) {
+      break;
+    }
+
+    if (iend - ip < 2) {
+      return -1;
+    }
+    uint64_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (!offset || offset > static_cast<uint64_t>(op - obase)) {
+      return -1;
+    }
+    uint64_t match_len = token & 15;
+    if (match_len == 15 && !read_len(&match_len)) {
+      return -1;
+    }
+    match_len += kMinMatch;
+    if (match_len > static_cast<uint64_t>(oend - op)) {
+      return -1;
+    }
+    auto *ref = op - offset;
+    if (offset >= match_len) {
+      memcpy(op, ref, match_len);
+      op += match_len;
+    } else {
+      while (match_len--) {
+        *op++ = *ref++;
+      }
+    }
+  }
+
+  return op - obase;
+}
+
+}  // namespace nu
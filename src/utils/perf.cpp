@@ -3,9 +3,12 @@ extern "C" {
 }
 
 #include <net.h>
+#include <runtime.h>
+#include <sync.h>
 
 #include <algorithm>
 #include <cmath>
+#include <deque>
 #include <numeric>
 #include <optional>
 #include <random>
@@ -15,13 +18,43 @@ extern "C" {
 
 namespace nu {
 
+struct Perf::OpenLoopLane {
+  rt::Mutex mutex;
+  rt::CondVar cv;
+  std::deque<uint64_t> intended_us;
+  uint32_t num_waiters = 0;
+  bool done = false;
+};
+
+PerfPhase PerfPhase::step(double mops, uint64_t duration_us) {
+  return PerfPhase{duration_us, mops, mops};
+}
+
+PerfPhase PerfPhase::ramp(double start_mops, double end_mops,
+                          uint64_t duration_us) {
+  return PerfPhase{duration_us, start_mops, end_mops};
+}
+
+double PerfPhase::mops_at(uint64_t offset_us) const {
+  if (!duration_us) {
+    return end_mops;
+  }
+  return start_mops + (end_mops - start_mops) * offset_us / duration_us;
+}
+
 Perf::Perf(PerfAdapter &adapter)
-    : adapter_(adapter), trace_format_(kUnsorted), real_mops_(0) {}
+    : adapter_(adapter),
+      trace_format_(kUnsorted),
+      real_mops_(0),
+      open_loop_(false) {}
 
 void Perf::reset() {
   traces_.clear();
   trace_format_ = kUnsorted;
   real_mops_ = 0;
+  open_loop_ = false;
+  histogram_.reset();
+  phase_histograms_.clear();
 }
 
 void Perf::gen_reqs(
@@ -120,6 +153,9 @@ void Perf::run_multi_clients(std::span<const netaddr> client_addrs,
                              uint32_t num_threads, double target_mops,
                              uint64_t duration_us, uint64_t warmup_us,
                              uint64_t miss_ddl_thresh_us) {
+  // Drops the results of any earlier run, including an open-loop one.
+  reset();
+
   std::vector<std::unique_ptr<PerfThreadState>> thread_states;
   create_thread_states(&thread_states, num_threads);
   std::vector<PerfRequestWithTime> all_warmup_reqs[num_threads];
@@ -138,6 +174,175 @@ void Perf::run_multi_clients(std::span<const netaddr> client_addrs,
   real_mops_ = static_cast<double>(traces_.size()) / real_duration_us;
 }
 
+void Perf::dispatch_open_loop(OpenLoopLane *lane,
+                              std::span<const PerfPhase> phases,
+                              uint32_t num_lanes, uint64_t start_us) {
+  constexpr static uint32_t kMaxBatchSize = 64;
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_real_distribution<double> coin(0, 1);
+  std::vector<uint64_t> batch;
+  batch.reserve(kMaxBatchSize);
+
+  auto flush = [&] {
+    if (batch.empty()) {
+      return;
+    }
+    rt::MutexGuard g(&lane->mutex);
+    lane->intended_us.insert(lane->intended_us.end(), batch.begin(),
+                             batch.end());
+    for (uint32_t i = 0; i < std::min<size_t>(batch.size(), lane->num_waiters);
+         i++) {
+      lane->cv.Signal();
+    }
+    batch.clear();
+  };
+
+  uint64_t phase_start_us = 0;
+  for (const auto &phase : phases) {
+    auto peak_mops = std::max(phase.start_mops, phase.end_mops);
+    if (peak_mops > 0) {
+      std::exponential_distribution<double> d(peak_mops / num_lanes);
+      double offset_us = 0;
+      while (true) {
+        offset_us += d(gen);
+        if (offset_us >= phase.duration_us) {
+          break;
+        }
+        // Thinning turns the peak-rate process into one that follows ramps.
+        if (coin(gen) * peak_mops > phase.mops_at(offset_us)) {
+          continue;
+        }
+        auto intended_us =
+            start_us + phase_start_us + static_cast<uint64_t>(offset_us);
+        if (intended_us > microtime()) {
+          flush();
+          timer_sleep_until(intended_us);
+        }
+        batch.push_back(intended_us);
+        if (batch.size() == kMaxBatchSize) {
+          flush();
+        }
+      }
+    }
+    phase_start_us += phase.duration_us;
+  }
+  flush();
+
+  rt::MutexGuard g(&lane->mutex);
+  lane->done = true;
+  lane->cv.SignalAll();
+}
+
+void Perf::benchmark_open_loop(
+    std::span<const PerfPhase> phases,
+    const std::vector<std::unique_ptr<PerfThreadState>> &thread_states,
+    uint32_t num_threads, bool record) {
+  auto num_lanes = std::min(num_threads, rt::RuntimeMaxCores());
+  std::vector<OpenLoopLane> lanes(num_lanes);
+  std::vector<std::vector<HdrHistogram>> all_phase_histograms(num_threads);
+  std::vector<uint64_t> all_last_end_us(num_threads);
+  std::vector<uint64_t> phase_end_us;
+  std::vector<rt::Thread> threads;
+
+  for (auto &phase_histograms : all_phase_histograms) {
+    phase_histograms.resize(phases.size());
+  }
+  auto start_us = microtime();
+  for (const auto &phase : phases) {
+    auto last_end_us = phase_end_us.empty() ? start_us : phase_end_us.back();
+    phase_end_us.push_back(last_end_us + phase.duration_us);
+  }
+
+  for (uint32_t i = 0; i < num_lanes; i++) {
+    threads.emplace_back([&, lane = &lanes[i]] {
+      dispatch_open_loop(lane, phases, num_lanes, start_us);
+    });
+  }
+
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, lane = &lanes[i % num_lanes],
+                          &phase_histograms = all_phase_histograms[i],
+                          &last_end_us = all_last_end_us[i],
+                          thread_state = thread_states[i].get()] {
+      while (true) {
+        uint64_t intended_us;
+        {
+          rt::MutexGuard g(&lane->mutex);
+          while (lane->intended_us.empty() && !lane->done) {
+            lane->num_waiters++;
+            lane->cv.Wait(&lane->mutex);
+            lane->num_waiters--;
+          }
+          if (lane->intended_us.empty()) {
+            break;
+          }
+          intended_us = lane->intended_us.front();
+          lane->intended_us.pop_front();
+        }
+
+        auto req = adapter_.gen_req(thread_state);
+        bool ok = adapter_.serve_req(thread_state, req.get());
+        auto end_us = microtime();
+        if (record && ok) {
+          auto phase_idx =
+              std::upper_bound(phase_end_us.begin(), phase_end_us.end(),
+                               intended_us) -
+              phase_end_us.begin();
+          phase_histograms[phase_idx].record(end_us - intended_us);
+          last_end_us = end_us;
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.Join();
+  }
+
+  if (record) {
+    open_loop_ = true;
+    histogram_.reset();
+    phase_histograms_.assign(phases.size(), HdrHistogram());
+    for (auto &phase_histograms : all_phase_histograms) {
+      for (uint32_t i = 0; i < phases.size(); i++) {
+        phase_histograms_[i].merge(phase_histograms[i]);
+        histogram_.merge(phase_histograms[i]);
+      }
+    }
+    auto real_end_us =
+        *std::max_element(all_last_end_us.begin(), all_last_end_us.end());
+    real_mops_ = real_end_us > start_us
+                     ? static_cast<double>(histogram_.count()) /
+                           (real_end_us - start_us)
+                     : 0;
+  }
+}
+
+void Perf::run_open_loop(std::span<const PerfPhase> phases,
+                         uint32_t num_threads, uint64_t warmup_us) {
+  run_open_loop_multi_clients(std::span<const netaddr>(), phases, num_threads,
+                              warmup_us);
+}
+
+void Perf::run_open_loop_multi_clients(std::span<const netaddr> client_addrs,
+                                       std::span<const PerfPhase> phases,
+                                       uint32_t num_threads,
+                                       uint64_t warmup_us) {
+  BUG_ON(phases.empty());
+  reset();
+  std::vector<std::unique_ptr<PerfThreadState>> thread_states;
+  create_thread_states(&thread_states, num_threads);
+  if (warmup_us) {
+    auto warmup_phase = PerfPhase::step(phases.front().start_mops, warmup_us);
+    benchmark_open_loop(std::span(&warmup_phase, 1), thread_states,
+                        num_threads, /* record = */ false);
+  }
+  tcp_barrier(client_addrs);
+  benchmark_open_loop(phases, thread_states, num_threads, /* record = */ true);
+}
+
 void Perf::tcp_barrier(std::span<const netaddr> participant_addrs) {
   if (participant_addrs.empty()) {
     return;
@@ -184,6 +389,10 @@ void Perf::tcp_barrier(std::span<const netaddr> participant_addrs) {
 }
 
 uint64_t Perf::get_average_lat() {
+  if (open_loop_) {
+    return histogram_.mean();
+  }
+
   if (trace_format_ != kSortedByDuration) {
     std::sort(traces_.begin(), traces_.end(),
               [](const Trace &x, const Trace &y) {
@@ -199,6 +408,10 @@ uint64_t Perf::get_average_lat() {
 }
 
 uint64_t Perf::get_nth_lat(double nth) {
+  if (open_loop_) {
+    return histogram_.percentile(nth);
+  }
+
   if (trace_format_ != kSortedByDuration) {
     std::sort(traces_.begin(), traces_.end(),
               [](const Trace &x, const Trace &y) {
@@ -242,6 +455,11 @@ std::vector<Trace> Perf::get_timeseries_nth_lats(uint64_t interval_us,
   return timeseries;
 }
 
+uint64_t Perf::get_phase_nth_lat(uint32_t phase_idx, double nth) const {
+  BUG_ON(phase_idx >= phase_histograms_.size());
+  return phase_histograms_[phase_idx].percentile(nth);
+}
+
 double Perf::get_real_mops() const { return real_mops_; }
 
 const std::vector<Trace> &Perf::get_traces() const { return traces_; }
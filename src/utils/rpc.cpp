@@ -1,3 +1,4 @@
+#include <cstring>
 #include <type_traits>
 
 extern "C" {
@@ -40,18 +41,20 @@ constexpr rpc_req_hdr MakeUpdateRequest(unsigned int demand) {
 struct rpc_resp_hdr {
   rpc_cmd cmd;                  // the command type
   unsigned int credits;         // the number of credits available
-  ssize_t len;                  // the length of this RPC response,
-                                // < 0 indicates an error
+  RPCReturnCode rc;             // the return code, != kOk indicates an error
+  std::size_t len;              // the length of this RPC response, errors may
+                                // carry data as well
   std::size_t completion_data;  // an opaque token to complete the RPC
 };
 
-constexpr rpc_resp_hdr MakeCallResponse(unsigned int credits, ssize_t len,
+constexpr rpc_resp_hdr MakeCallResponse(unsigned int credits, RPCReturnCode rc,
+                                        std::size_t len,
                                         std::size_t completion_data) {
-  return rpc_resp_hdr{rpc_cmd::call, credits, len, completion_data};
+  return rpc_resp_hdr{rpc_cmd::call, credits, rc, len, completion_data};
 }
 
 constexpr rpc_resp_hdr MakeUpdateResponse(unsigned int credits) {
-  return rpc_resp_hdr{rpc_cmd::update, credits, 0, 0};
+  return rpc_resp_hdr{rpc_cmd::update, credits, kOk, 0, 0};
 }
 
 }  // namespace
@@ -64,32 +67,83 @@ void RPCCompletion::Poll() const {
   }
 }
 
-void RPCCompletion::Done(ssize_t len, rt::TcpConn *c) {
-  if (unlikely(len < 0)) {
-    rc_ = static_cast<RPCReturnCode>(len);
-  } else {
-    rc_ = kOk;
-
-    if (callback_) {
-      callback_(len, c);
-    } else if (len) {
-      auto buf = std::make_unique_for_overwrite<std::byte[]>(len);
-      auto ret = c->ReadFull(buf.get(), len);
-      if (unlikely(ret <= 0)) {
-        log_err("rpc: ReadFull failed, err = %ld", ret);
-      }
+void RPCCompletion::Done(RPCReturnCode rc, std::size_t len, RPCConn *c) {
+  rc_ = rc;
+  if (rc == kOk && callback_) {
+    callback_(len, c);
+  } else if (len) {
+    auto buf = std::make_unique_for_overwrite<std::byte[]>(len);
+    auto ret = c->ReadFull(buf.get(), len);
+    if (unlikely(ret <= 0)) {
+      log_err("rpc: ReadFull failed, err = %ld", ret);
+    }
+    // Callbacks only handle successful responses, error data is dropped.
+    if (return_buf_) {
       auto span = std::span<const std::byte>(buf.get(), len);
       return_buf_->Reset(span, [buf = std::move(buf)] {});
     }
   }
 
-  poll_ = false;
+  Finish();
+}
+
+void RPCCompletion::Done(RPCReturnCode rc, std::span<const std::byte> buf) {
+  // Callbacks consume the response from the flow's connection.
+  BUG_ON(callback_);
+  rc_ = rc;
+  if (!buf.empty()) {
+    auto copied = std::make_unique_for_overwrite<std::byte[]>(buf.size());
+    memcpy(copied.get(), buf.data(), buf.size());
+    auto span = std::span<const std::byte>(copied.get(), buf.size());
+    return_buf_->Reset(span, [copied = std::move(copied)] {});
+  }
+
+  Finish();
+}
+
+void RPCCompletion::Finish() {
+  if (!tracked_) {
+    poll_ = false;
+    w_.Wake();
+    return;
+  }
+
+  rt::SpinGuard guard(&lock_);
+  done_ = true;
+  w_.Wake();
+}
+
+void RPCCompletion::Sent() {
+  rt::SpinGuard guard(&lock_);
+  sent_ = true;
   w_.Wake();
 }
 
+void RPCCompletion::WaitFor(const bool *flag) {
+  // The response may arrive before Sent() is called, so unlike untracked
+  // completions, the caller has to check its flag under the lock.
+  if (poll_) {
+    while (!rt::access_once(*flag)) {
+      get_runtime()->caladan()->unblock_and_relax();
+    }
+    return;
+  }
+
+  rt::SpinGuard guard(&lock_);
+  while (!*flag) guard.Park(&w_);
+}
+
+void RPCCompletion::WaitSent() { WaitFor(&sent_); }
+
+RPCReturnCode RPCCompletion::WaitDone() {
+  WaitFor(&done_);
+  return rc_;
+}
+
 RPCServerWorker::RPCServerWorker(std::unique_ptr<rt::TcpConn> c,
                                  nu::RPCHandler &handler, Counter &counter)
-    : c_(std::move(c)),
+    : client_ip_(c->RemoteAddr().ip),
+      c_(std::make_unique<RPCConn>(std::move(c))),
       handler_(handler),
       close_(false),
       counter_(counter),
@@ -132,8 +186,8 @@ void RPCServerWorker::SendWorker() {
     hdrs.reserve(completions.size());
     for (const auto &c : completions) {
       auto span = c.buf.get_buf();
-      hdrs.emplace_back(MakeCallResponse(
-          credits_, c.rc == kOk ? span.size_bytes() : c.rc, c.completion_data));
+      hdrs.emplace_back(MakeCallResponse(credits_, c.rc, span.size_bytes(),
+                                         c.completion_data));
       iovecs.emplace_back(&hdrs.back(), sizeof(decltype(hdrs)::value_type));
       if (span.size_bytes() == 0) continue;
       iovecs.emplace_back(const_cast<std::byte *>(span.data()),
@@ -152,7 +206,12 @@ void RPCServerWorker::SendWorker() {
 }
 
 void RPCServerWorker::ReceiveWorker() {
-  while (true) {
+  bool negotiated = c_->Accept();
+  if (unlikely(!negotiated)) {
+    log_err("rpc: transport negotiation failed");
+  }
+
+  while (negotiated) {
     // Read the request header.
     rpc_req_hdr hdr;
     ssize_t ret = c_->ReadFull(&hdr, sizeof(hdr));
@@ -172,7 +231,7 @@ void RPCServerWorker::ReceiveWorker() {
       counter_.inc();
       // TODO: avoid dynamic memory allocation.
       rt::Spawn([this, completion_data]() {
-        auto returner = RPCReturner(this, completion_data);
+        auto returner = RPCReturner(this, client_ip_, completion_data);
         handler_(std::span<std::byte>{}, &returner);
         counter_.dec();
       });
@@ -193,7 +252,7 @@ void RPCServerWorker::ReceiveWorker() {
     // TODO: avoid dynamic memory allocation.
     rt::Spawn(
         [this, completion_data, b = std::move(buf), len = hdr.len]() mutable {
-          auto returner = RPCReturner(this, completion_data);
+          auto returner = RPCReturner(this, client_ip_, completion_data);
           handler_(std::span<std::byte>{b.get(), len}, &returner);
           counter_.dec();
         });
@@ -267,13 +326,18 @@ void RPCFlow::SendWorker() {
     hdrs.reserve(reqs.size());
     for (const auto &r : reqs) {
       auto &span = r.payload;
-      hdrs.emplace_back(
-          MakeCallRequest(demand, span.size_bytes(),
-                          reinterpret_cast<std::size_t>(r.completion)));
+      auto len = span.size_bytes();
+      for (const auto &seg : r.bulk) {
+        len += seg.iov_len;
+      }
+      hdrs.emplace_back(MakeCallRequest(
+          demand, len, reinterpret_cast<std::size_t>(r.completion)));
       iovecs.emplace_back(&hdrs.back(), sizeof(decltype(hdrs)::value_type));
-      if (span.size_bytes() == 0) continue;
-      iovecs.emplace_back(const_cast<std::byte *>(span.data()),
-                          span.size_bytes());
+      if (span.size_bytes() != 0) {
+        iovecs.emplace_back(const_cast<std::byte *>(span.data()),
+                            span.size_bytes());
+      }
+      iovecs.insert(iovecs.end(), r.bulk.begin(), r.bulk.end());
     }
 
     // send data on the wire.
@@ -282,6 +346,10 @@ void RPCFlow::SendWorker() {
       log_err("rpc: WritevFull failed, err = %ld", ret);
       return;
     }
+    // Untracked completions may already be gone, so only touch the others.
+    for (const auto &r : reqs) {
+      if (!r.bulk.empty()) r.completion->Sent();
+    }
     reqs.clear();
   }
 
@@ -308,17 +376,18 @@ void RPCFlow::ReceiveWorker() {
     }
 
     if (hdr.cmd != rpc_cmd::call) continue;
+    // The completion has been done through RPCClient::CompleteDirectly().
+    if (hdr.rc == kDirectlyReturned) continue;
 
     // Check if there is no return data.
     auto *completion = reinterpret_cast<RPCCompletion *>(hdr.completion_data);
-    completion->Done(hdr.len, c_.get());
+    completion->Done(hdr.rc, hdr.len, c_.get());
   }
 }
 
 std::unique_ptr<RPCFlow> RPCFlow::New(unsigned int cpu_affinity,
                                       netaddr raddr) {
-  std::unique_ptr<rt::TcpConn> c(
-      rt::TcpConn::DialAffinity(cpu_affinity, raddr));
+  auto c = RPCConn::Dial(cpu_affinity, raddr);
   BUG_ON(!c);
   std::unique_ptr<RPCFlow> f = std::make_unique<RPCFlow>(std::move(c));
   f->sender_ = rt::Thread([f = f.get()] { f->SendWorker(); });
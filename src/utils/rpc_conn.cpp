@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C" {
+#include <base/log.h>
+#include <runtime/timer.h>
+}
+#include <thread.h>
+
+#include "nu/commons.hpp"
+#include "nu/utils/rpc_conn.hpp"
+
+namespace nu {
+
+namespace {
+
+constexpr std::size_t kHostIdLen = 40;
+constexpr std::size_t kShmNameLen = 64;
+
+// Sent by the client right after connecting.
+struct shm_hello {
+  bool want_shm;
+  char host_id[kHostIdLen];
+};
+
+// Identifies the host, so that the two ends can tell whether they are
+// co-located. Returns false if it is unknown.
+bool get_host_id(char *host_id) {
+  static char id[kHostIdLen];
+  static bool valid = [] {
+    auto *f = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (!f) return false;
+    auto ok = fgets(id, sizeof(id), f) != nullptr;
+    fclose(f);
+    return ok;
+  }();
+
+  if (!valid) return false;
+  memcpy(host_id, id, kHostIdLen);
+  return true;
+}
+
+}  // namespace
+
+// The bytes on the TCP doorbell, all consumed by the reader. Only data bells
+// wake it up, so that probes and space bells never leave it out of sync.
+enum RPCConn::Bell : uint8_t {
+  kDataBell,
+  // Tells the writer that the peer's reader has freed space in its ring.
+  kSpaceBell,
+  // Sent by a parked writer to check that the connection is alive.
+  kProbeBell,
+};
+
+// A single-producer single-consumer byte ring. It lives in memory shared by two
+// processes, so all of its state is in place and starts zeroed.
+struct RPCConn::ShmRing {
+  // Written by the consumer.
+  alignas(kCacheLineBytes) std::atomic<uint64_t> head;
+  std::atomic<bool> reader_closed;
+  // Written by the producer.
+  alignas(kCacheLineBytes) std::atomic<uint64_t> tail;
+  std::atomic<bool> writer_closed;
+  // Set by a consumer about to park on the doorbell, cleared by whoever rings.
+  alignas(kCacheLineBytes) std::atomic<bool> reader_parked;
+  // Likewise, set by a producer about to park on a full ring.
+  std::atomic<bool> writer_parked;
+  alignas(kCacheLineBytes) std::byte data[kShmRingSize];
+
+  bool empty() const { return head.load() == tail.load(); }
+  bool full() const { return tail.load() - head.load() == kShmRingSize; }
+
+  std::size_t write(const std::byte *src, std::size_t len) {
+    auto t = tail.load(std::memory_order_relaxed);
+    auto h = head.load(std::memory_order_acquire);
+    len = std::min(len, kShmRingSize - (t - h));
+    auto off = t % kShmRingSize;
+    auto first = std::min(len, kShmRingSize - off);
+    memcpy(data + off, src, first);
+    memcpy(data, src + first, len - first);
+    // Pairs with the reader_parked handshake, so must not be weaker.
+    tail.store(t + len, std::memory_order_seq_cst);
+    return len;
+  }
+
+  std::size_t read(std::byte *dst, std::size_t len) {
+    auto h = head.load(std::memory_order_relaxed);
+    auto t = tail.load(std::memory_order_acquire);
+    len = std::min(len, t - h);
+    auto off = h % kShmRingSize;
+    auto first = std::min(len, kShmRingSize - off);
+    memcpy(dst, data + off, first);
+    memcpy(dst + first, data, len - first);
+    // Pairs with the writer_parked handshake, so must not be weaker.
+    head.store(h + len, std::memory_order_seq_cst);
+    return len;
+  }
+};
+
+RPCConn::RPCConn(std::unique_ptr<rt::TcpConn> c)
+    : c_(std::move(c)), shm_(nullptr), tx_(nullptr), rx_(nullptr) {}
+
+RPCConn::~RPCConn() {
+  if (shm_) {
+    munmap(shm_, sizeof(ShmRing) * 2);
+  }
+}
+
+std::unique_ptr<RPCConn> RPCConn::Dial(unsigned int cpu_affinity,
+                                       netaddr raddr, bool allow_shm) {
+  std::unique_ptr<rt::TcpConn> c(
+      rt::TcpConn::DialAffinity(cpu_affinity, raddr));
+  if (unlikely(!c)) return nullptr;
+  auto conn = std::make_unique<RPCConn>(std::move(c));
+  if (unlikely(!conn->Negotiate(allow_shm))) return nullptr;
+  return conn;
+}
+
+bool RPCConn::MapShm(const char *name, bool create) {
+  constexpr auto kLen = sizeof(ShmRing) * 2;
+
+  int fd = shm_open(name, O_RDWR | (create ? O_CREAT | O_EXCL : 0), 0600);
+  if (fd < 0) return false;
+  if (create && ftruncate(fd, kLen)) {
+    close(fd);
+    shm_unlink(name);
+    return false;
+  }
+  auto *addr = mmap(nullptr, kLen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    if (create) shm_unlink(name);
+    return false;
+  }
+  shm_ = addr;
+  return true;
+}
+
+bool RPCConn::Negotiate(bool allow_shm) {
+  static std::atomic<uint64_t> shm_seq;
+
+  shm_hello hello{};
+  hello.want_shm = allow_shm && get_host_id(hello.host_id);
+  if (c_->WriteFull(&hello, sizeof(hello)) <= 0) return false;
+  bool same_host;
+  if (c_->ReadFull(&same_host, sizeof(same_host)) <= 0) return false;
+  if (!same_host) return true;
+
+  char name[kShmNameLen] = {};
+  snprintf(name, sizeof(name), "/nu-rpc-%d-%lu", getpid(),
+           shm_seq.fetch_add(1, std::memory_order_relaxed));
+  auto mapped = MapShm(name, /* create = */ true);
+  if (!mapped) name[0] = '\0';
+  bool ok = false;
+  auto sent = c_->WriteFull(name, sizeof(name)) > 0 &&
+              c_->ReadFull(&ok, sizeof(ok)) > 0;
+  // Both ends have mapped it (or given up) by now.
+  if (mapped) shm_unlink(name);
+  if (!sent) return false;
+
+  if (!ok) {
+    if (mapped) {
+      munmap(shm_, sizeof(ShmRing) * 2);
+      shm_ = nullptr;
+    }
+    return true;
+  }
+  tx_ = &reinterpret_cast<ShmRing *>(shm_)[0];
+  rx_ = &reinterpret_cast<ShmRing *>(shm_)[1];
+  return true;
+}
+
+bool RPCConn::Accept() {
+  shm_hello hello;
+  if (c_->ReadFull(&hello, sizeof(hello)) <= 0) return false;
+  char host_id[kHostIdLen];
+  bool same_host = kEnableShm && hello.want_shm && get_host_id(host_id) &&
+                   !memcmp(host_id, hello.host_id, kHostIdLen);
+  if (c_->WriteFull(&same_host, sizeof(same_host)) <= 0) return false;
+  if (!same_host) return true;
+
+  char name[kShmNameLen];
+  if (c_->ReadFull(name, sizeof(name)) <= 0) return false;
+  name[kShmNameLen - 1] = '\0';
+  bool ok = name[0] && MapShm(name, /* create = */ false);
+  if (c_->WriteFull(&ok, sizeof(ok)) <= 0) return false;
+  if (!ok) return true;
+
+  tx_ = &reinterpret_cast<ShmRing *>(shm_)[1];
+  rx_ = &reinterpret_cast<ShmRing *>(shm_)[0];
+  return true;
+}
+
+bool RPCConn::SendBell(Bell bell) {
+  return c_->WriteFull(&bell, sizeof(bell)) > 0;
+}
+
+bool RPCConn::RingDoorbell() {
+  // Exactly one data bell per parked reader, which waits for it.
+  if (!tx_->reader_parked.exchange(false)) return true;
+  return SendBell(kDataBell);
+}
+
+bool RPCConn::RingSpaceBell() {
+  if (likely(!rx_->writer_parked.load())) return true;
+  if (!rx_->writer_parked.exchange(false)) return true;
+  return SendBell(kSpaceBell);
+}
+
+void RPCConn::WakeWriter() {
+  // Under the lock, so that the writer can't miss it between checking the
+  // ring and parking.
+  rt::ScopedLock lock(&space_mutex_);
+  space_cv_.Signal();
+}
+
+bool RPCConn::WaitForRead() {
+  auto deadline = microtime() + kShmPollUs;
+  do {
+    // Data is published before the close flag, so check it afterwards.
+    if (rx_->writer_closed.load()) return !rx_->empty();
+    if (!rx_->empty()) return true;
+    rt::Yield();
+  } while (microtime() < deadline);
+
+  rx_->reader_parked.store(true);
+  if ((!rx_->empty() || rx_->writer_closed.load()) &&
+      rx_->reader_parked.exchange(false)) {
+    return true;
+  }
+  // Either nothing has arrived yet, or the writer has already cleared the flag
+  // and the data bell is on its way. Consume it in both cases to keep the TCP
+  // stream in sync.
+  while (true) {
+    Bell bell;
+    if (c_->ReadFull(&bell, sizeof(bell)) <= 0) return !rx_->empty();
+    if (bell == kDataBell) return true;
+    if (bell == kSpaceBell) WakeWriter();
+  }
+}
+
+bool RPCConn::WaitForSpace() {
+  // Make sure the reader is draining the ring.
+  if (unlikely(!RingDoorbell())) return false;
+
+  auto deadline = microtime() + kShmPollUs;
+  do {
+    if (!tx_->full() || tx_->reader_closed.load()) return true;
+    rt::Yield();
+  } while (microtime() < deadline);
+
+  rt::ScopedLock lock(&space_mutex_);
+  tx_->writer_parked.store(true);
+  while (tx_->full() && !tx_->reader_closed.load()) {
+    if (!space_cv_.WaitFor(&space_mutex_, kShmProbeIntervalUs)) {
+      // A crashed reader never closes the ring.
+      if (unlikely(!SendBell(kProbeBell))) return false;
+    }
+  }
+  // A space bell may still arrive, but it only causes a spurious wakeup.
+  tx_->writer_parked.store(false);
+  return true;
+}
+
+ssize_t RPCConn::ReadFull(void *buf, std::size_t len) {
+  if (!shm_) return c_->ReadFull(buf, len);
+
+  auto *pos = reinterpret_cast<std::byte *>(buf);
+  std::size_t n = 0;
+  while (n < len) {
+    auto ret = rx_->read(pos + n, len - n);
+    if (ret) {
+      n += ret;
+      // The writer can't make progress until told. A broken connection will
+      // be noticed once the ring runs dry.
+      RingSpaceBell();
+      continue;
+    }
+    if (!WaitForRead()) return 0;
+  }
+  return n;
+}
+
+ssize_t RPCConn::WritevFull(std::span<const iovec> iov) {
+  if (!shm_) return c_->WritevFull(iov);
+
+  ssize_t total = 0;
+  for (const auto &v : iov) {
+    auto *pos = reinterpret_cast<const std::byte *>(v.iov_base);
+    std::size_t n = 0;
+    while (n < v.iov_len) {
+      if (unlikely(tx_->reader_closed.load(std::memory_order_relaxed))) {
+        return -EPIPE;
+      }
+      auto ret = tx_->write(pos + n, v.iov_len - n);
+      if (!ret) {
+        if (unlikely(!WaitForSpace())) return -EPIPE;
+        continue;
+      }
+      n += ret;
+    }
+    total += v.iov_len;
+  }
+  if (unlikely(!RingDoorbell())) return -EPIPE;
+  return total;
+}
+
+int RPCConn::Shutdown(int how) {
+  if (shm_) {
+    if (how != SHUT_RD) {
+      tx_->writer_closed.store(true);
+      RingDoorbell();
+    }
+    if (how != SHUT_WR) {
+      rx_->reader_closed.store(true);
+      // Lets a parked writer notice.
+      RingSpaceBell();
+    }
+  }
+  return c_->Shutdown(how);
+}
+
+void RPCConn::Abort() {
+  if (shm_) {
+    tx_->writer_closed.store(true);
+    rx_->reader_closed.store(true);
+  }
+  c_->Abort();
+}
+
+}  // namespace nu
@@ -69,9 +69,34 @@ inline uint32_t get_max_num_cache_entries(bool aggressive_caching,
   }
 }
 
+SlabAllocator::CoreCaches *SlabAllocator::get_or_create_core_caches(
+    uint32_t cpu) {
+  auto *core_caches = core_caches_[cpu];
+  if (likely(core_caches)) {
+    return core_caches;
+  }
+
+  // Only the owner core creates its caches, so there is no creation race.
+  ScopedLock lock(&spin_);
+  auto addr = reinterpret_cast<uintptr_t>(cur_);
+  addr = ((addr - 1) / alignof(CoreCaches) + 1) * alignof(CoreCaches);
+  auto *new_cur = reinterpret_cast<uint8_t *>(addr) + sizeof(CoreCaches);
+  if (unlikely(new_cur > end_)) {
+    return nullptr;
+  }
+  cur_ = new_cur;
+  core_caches = new (reinterpret_cast<void *>(addr)) CoreCaches();
+  store_release(&core_caches_[cpu], core_caches);
+  return core_caches;
+}
+
 inline void SlabAllocator::drain_transferred_cache(
     const Caladan::PreemptGuard &g, uint32_t slab_shift) {
-  auto &transferred_cache = transferred_caches_[g.read_cpu()];
+  auto *core_caches = core_caches_[g.read_cpu()];
+  if (unlikely(!core_caches)) {
+    return;
+  }
+  auto &transferred_cache = core_caches->transferred;
   auto &list = transferred_cache.lists[slab_shift];
 
   if (list.size()) {
@@ -94,7 +119,11 @@ void *SlabAllocator::__allocate(size_t size) {
 
     drain_transferred_cache(g, slab_shift);
     cpu = g.read_cpu();
-    auto &cache_list = cache_lists_[cpu].lists[slab_shift];
+    auto *core_caches = get_or_create_core_caches(cpu);
+    if (unlikely(!core_caches)) {
+      return nullptr;
+    }
+    auto &cache_list = core_caches->cache.lists[slab_shift];
     if (likely(cache_list.size())) {
       ret = cache_list.pop();
     }
@@ -202,7 +231,7 @@ void SlabAllocator::free_to_cache_list(const Caladan::PreemptGuard &g,
                                        PtrHeader *hdr, uint32_t slab_shift) {
   auto max_num_cache_entries =
       get_max_num_cache_entries(aggressive_caching_, slab_shift);
-  auto &cache_list = cache_lists_[g.read_cpu()].lists[slab_shift];
+  auto &cache_list = core_caches_[g.read_cpu()]->cache.lists[slab_shift];
   cache_list.push(hdr);
 
   if (unlikely(cache_list.size() > max_num_cache_entries)) {
@@ -220,9 +249,10 @@ void SlabAllocator::free_to_transferred_cache_list(PtrHeader *hdr,
                                                    uint32_t slab_shift) {
   auto max_num_cache_entries =
       get_max_num_cache_entries(aggressive_caching_, slab_shift);
-  auto &transferred_cache = transferred_caches_[hdr->core_id];
+  auto *core_caches = core_caches_[hdr->core_id];
+  auto &transferred_cache = core_caches->transferred;
   auto &transferred_cache_list = transferred_cache.lists[slab_shift];
-  auto &cache_list = cache_lists_[hdr->core_id].lists[slab_shift];
+  auto &cache_list = core_caches->cache.lists[slab_shift];
 
   ScopedLock lock(&transferred_cache.spin);
   transferred_cache.lists[slab_shift].push(hdr);
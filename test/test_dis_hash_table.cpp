@@ -114,6 +114,80 @@ bool run_test() {
     return false;
   }
 
+  our_set.clear();
+  auto cursor = hash_table.get_cursor(/* chunk_size = */ 1000);
+  while (auto chunk = cursor.next()) {
+    our_set.insert(chunk->begin(), chunk->end());
+  }
+  if (std_set != our_set) {
+    return false;
+  }
+
+  std::set<std::string> std_keys, our_keys;
+  for (auto &[k, _] : std_map) {
+    std_keys.emplace(k);
+  }
+  hash_table.for_each_chunk(
+      [&](std::vector<std::string> &keys) {
+        our_keys.insert(keys.begin(), keys.end());
+      },
+      /* chunk_size = */ 1000,
+      /* map_fn = */
+      +[](std::vector<std::string> &keys, std::pair<const K, V> &pair) {
+        keys.emplace_back(pair.first);
+      });
+  if (std_keys != our_keys) {
+    return false;
+  }
+
+  auto starts_with_a = +[](std::pair<const K, V> &pair) {
+    return pair.first[0] == 'A';
+  };
+  auto std_cnt = std::count_if(std_map.begin(), std_map.end(),
+                               [](auto &pair) { return pair.first[0] == 'A'; });
+  if (hash_table.count_if(starts_with_a) != static_cast<uint64_t>(std_cnt)) {
+    return false;
+  }
+
+  auto filtered = make_dis_hash_table<std::string, std::string>(3);
+  hash_table.filter_to(filtered, starts_with_a);
+  for (auto &[k, v] : std_map) {
+    if (filtered.get(k) != (k[0] == 'A' ? std::optional(v) : std::nullopt)) {
+      return false;
+    }
+  }
+
+  auto lens = make_dis_hash_table<std::string, uint64_t>(4);
+  hash_table.map_to(
+      lens, +[](std::vector<std::pair<std::string, uint64_t>> &outputs,
+                std::pair<const K, V> &pair) {
+        outputs.emplace_back(pair.first + pair.second, pair.first.size());
+      });
+  lens.transform_values(
+      +[](std::pair<const std::string, uint64_t> &pair, uint64_t factor) {
+        pair.second *= factor;
+      },
+      2ULL);
+  for (auto &[k, v] : std_map) {
+    if (lens.get(k + v) != 2 * kKeyLen) {
+      return false;
+    }
+  }
+
+  auto top = hash_table.top_k(
+      10, +[](const std::pair<const K, V> &pair) { return pair.first; });
+  std::vector<std::string> std_top;
+  for (auto &[k, _] : std_map) {
+    std_top.emplace_back(k);
+  }
+  std::sort(std_top.begin(), std_top.end(), std::greater<>());
+  std_top.resize(10);
+  for (uint32_t i = 0; i < std_top.size(); i++) {
+    if (top[i].first != std_top[i]) {
+      return false;
+    }
+  }
+
   for (auto &[k, _] : std_map) {
     if (!hash_table_3.remove(k)) {
       return false;
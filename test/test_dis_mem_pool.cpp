@@ -1,6 +1,7 @@
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 extern "C" {
 #include <net/ip.h>
@@ -16,6 +17,9 @@ using namespace nu;
 
 constexpr static uint32_t kNumThreads = 100;
 constexpr static uint32_t kNumAllocationsPerThread = 100000;
+// Twice what a shard can hold, even without the per-object headers.
+constexpr static uint32_t kNumBatchedAllocations =
+    2 * DistributedMemPool::kShardSize / sizeof(uint64_t);
 
 bool run_single_thread() {
   std::vector<int> a{1, 2, 3, 4, 5, 6};
@@ -46,6 +50,70 @@ bool run_single_thread() {
   return true;
 }
 
+bool run_batched() {
+  DistributedMemPool dis_mem_pool;
+
+  // Spans multiple shards, see kNumBatchedAllocations.
+  auto raw_ptrs = dis_mem_pool.allocate_raw_n<uint64_t>(
+      kNumBatchedAllocations, static_cast<uint64_t>(42));
+  if (raw_ptrs.size() != kNumBatchedAllocations) {
+    return false;
+  }
+  for (auto &raw_ptr : raw_ptrs) {
+    if (*raw_ptr != 42) {
+      return false;
+    }
+  }
+  dis_mem_pool.free_raw_n(raw_ptrs);
+
+  // Served from the reserved slots.
+  std::vector<RemRawPtr<uint64_t>> slot_ptrs;
+  for (uint64_t i = 0; i < 4 * DistributedMemPool::kNumSlotsPerReservation;
+       i++) {
+    auto slot_ptr = dis_mem_pool.allocate_raw<uint64_t>();
+    if (*slot_ptr != 0) {
+      return false;
+    }
+    slot_ptr.run(+[](uint64_t &v, uint64_t i) { v = i; }, i);
+    slot_ptrs.emplace_back(std::move(slot_ptr));
+  }
+  for (uint64_t i = 0; i < slot_ptrs.size(); i++) {
+    if (*slot_ptrs[i] != i) {
+      return false;
+    }
+  }
+  dis_mem_pool.free_raw_n(slot_ptrs);
+
+  return true;
+}
+
+bool run_cached_reuse() {
+  constexpr uint32_t kNumReallocations = 4096;
+
+  DistributedMemPool dis_mem_pool;
+  auto rem_raw_ptr = dis_mem_pool.allocate_raw<uint64_t>(uint64_t{1});
+  if (rem_raw_ptr.read_cached(kOneSecond) != 1) {
+    return false;
+  }
+  auto *freed_addr = rem_raw_ptr.get();
+  dis_mem_pool.free_raw(rem_raw_ptr);
+
+  // Cached reads stay exact once the freed address is handed out again.
+  std::vector<RemRawPtr<uint64_t>> new_ptrs;
+  bool reused = false;
+  for (uint32_t i = 0; i < kNumReallocations && !reused; i++) {
+    auto new_ptr = dis_mem_pool.allocate_raw<uint64_t>(uint64_t{2});
+    reused = new_ptr.get() == freed_addr;
+    if (new_ptr.read_cached(kOneSecond) != 2) {
+      return false;
+    }
+    new_ptrs.emplace_back(std::move(new_ptr));
+  }
+  dis_mem_pool.free_raw_n(new_ptrs);
+
+  return reused;
+}
+
 bool run_multi_thread() {
   DistributedMemPool dis_mem_pool;
   std::vector<rt::Thread> alloc_threads;
@@ -85,7 +153,10 @@ bool run_multi_thread() {
   return ACCESS_ONCE(match);
 }
 
-bool run_test() { return run_single_thread() && run_multi_thread(); }
+bool run_test() {
+  return run_single_thread() && run_batched() && run_cached_reuse() &&
+         run_multi_thread();
+}
 
 void do_work() {
   if (run_test()) {
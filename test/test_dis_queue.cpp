@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <net/ip.h>
+}
+#include <runtime.h>
+#include <thread.h>
+
+#include "nu/dis_queue.hpp"
+#include "nu/runtime.hpp"
+
+using namespace nu;
+
+constexpr static uint32_t kNumShards = 4;
+constexpr static uint32_t kNumProducers = 4;
+constexpr static uint32_t kNumConsumers = 8;
+constexpr static uint64_t kNumElemsPerProducer = 100000;
+constexpr static uint32_t kPopBatchSize = 32;
+
+void do_work() {
+  auto queue = make_dis_queue<uint64_t>(kNumShards);
+
+  constexpr uint64_t kNumElems = kNumProducers * kNumElemsPerProducer;
+  constexpr uint64_t kNumElemsPerConsumer = kNumElems / kNumConsumers;
+  std::vector<uint64_t> sums(kNumConsumers);
+  std::vector<rt::Thread> threads;
+
+  // Consumers start first so that some of them block on the empty queue.
+  for (uint32_t i = 0; i < kNumConsumers; i++) {
+    threads.emplace_back([&, i, queue]() mutable {
+      uint64_t num_popped = 0;
+      while (num_popped < kNumElemsPerConsumer) {
+        auto num = std::min(static_cast<uint64_t>(kPopBatchSize),
+                            kNumElemsPerConsumer - num_popped);
+        auto elems = queue.pop(num);
+        for (auto elem : elems) {
+          sums[i] += elem;
+        }
+        num_popped += elems.size();
+      }
+    });
+  }
+  for (uint32_t i = 0; i < kNumProducers; i++) {
+    threads.emplace_back([&, i, queue]() mutable {
+      for (uint64_t j = 0; j < kNumElemsPerProducer; j++) {
+        queue.push(i * kNumElemsPerProducer + j);
+      }
+      queue.flush();
+    });
+  }
+  for (auto &thread : threads) {
+    thread.Join();
+  }
+
+  uint64_t sum = 0;
+  for (auto s : sums) {
+    sum += s;
+  }
+  bool passed = (sum == kNumElems * (kNumElems - 1) / 2) && !queue.size();
+
+  if (passed) {
+    std::cout << "Passed" << std::endl;
+  } else {
+    std::cout << "Failed" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) { do_work(); });
+}
@@ -0,0 +1,115 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "nu/runtime.hpp"
+#include "nu/utils/lz4.hpp"
+
+using namespace nu;
+
+bool round_trip(const std::vector<std::byte> &input) {
+  auto lz4 = std::make_unique<LZ4>();
+  std::vector<std::byte> compressed(LZ4::compress_bound(input.size()));
+  auto compressed_len = lz4->compress(input.data(), input.size(),
+                                      compressed.data(), compressed.size());
+  // Even an empty input is encoded as a (literal-free) sequence.
+  if (!compressed_len || compressed_len > compressed.size()) {
+    return false;
+  }
+
+  std::vector<std::byte> decompressed(input.size());
+  auto decompressed_len =
+      LZ4::decompress(compressed.data(), compressed_len, decompressed.data(),
+                      decompressed.size());
+  if (decompressed_len != static_cast<int64_t>(input.size())) {
+    return false;
+  }
+  return decompressed == input;
+}
+
+std::vector<std::byte> make_compressible(uint64_t len) {
+  std::vector<std::byte> input(len);
+  for (uint64_t i = 0; i < len; i++) {
+    input[i] = static_cast<std::byte>((i / 8) % 16);
+  }
+  return input;
+}
+
+std::vector<std::byte> make_incompressible(uint64_t len) {
+  std::mt19937_64 gen(len);
+  std::vector<std::byte> input(len);
+  for (auto &b : input) {
+    b = static_cast<std::byte>(gen());
+  }
+  return input;
+}
+
+bool run_empty() { return round_trip({}); }
+
+bool run_compressible() {
+  for (uint64_t len : {1, 12, 13, 4096, 65536}) {
+    if (!round_trip(make_compressible(len))) {
+      return false;
+    }
+  }
+
+  auto input = make_compressible(LZ4::kMaxInputSize);
+  auto lz4 = std::make_unique<LZ4>();
+  std::vector<std::byte> compressed(LZ4::compress_bound(input.size()));
+  auto compressed_len = lz4->compress(input.data(), input.size(),
+                                      compressed.data(), compressed.size());
+  return compressed_len && compressed_len < input.size() / 8;
+}
+
+bool run_incompressible() {
+  for (uint64_t len : {1, 12, 13, 4096, 65536}) {
+    if (!round_trip(make_incompressible(len))) {
+      return false;
+    }
+  }
+
+  // Gives up once the output would exceed the destination capacity.
+  auto input = make_incompressible(LZ4::kMaxInputSize);
+  auto lz4 = std::make_unique<LZ4>();
+  std::vector<std::byte> compressed(input.size());
+  return !lz4->compress(input.data(), input.size(), compressed.data(),
+                        input.size() * 7 / 8);
+}
+
+bool run_malformed() {
+  auto input = make_compressible(4096);
+  auto lz4 = std::make_unique<LZ4>();
+  std::vector<std::byte> compressed(LZ4::compress_bound(input.size()));
+  auto compressed_len = lz4->compress(input.data(), input.size(),
+                                      compressed.data(), compressed.size());
+
+  std::vector<std::byte> decompressed(input.size());
+  // The output doesn't fit.
+  if (LZ4::decompress(compressed.data(), compressed_len, decompressed.data(),
+                      input.size() - 1) != -1) {
+    return false;
+  }
+  // A match reaching before the output start.
+  const std::byte bad_offset[] = {std::byte{0x10}, std::byte{0},
+                                  std::byte{2}, std::byte{0}};
+  return LZ4::decompress(bad_offset, sizeof(bad_offset), decompressed.data(),
+                         decompressed.size()) == -1;
+}
+
+bool run() {
+  return run_empty() && run_compressible() && run_incompressible() &&
+         run_malformed();
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) {
+    if (run()) {
+      std::cout << "Passed" << std::endl;
+    } else {
+      std::cout << "Failed" << std::endl;
+    }
+  });
+}
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <net/ip.h>
+}
+#include <runtime.h>
+
+#include "nu/micro_proclet.hpp"
+#include "nu/runtime.hpp"
+
+using namespace nu;
+
+constexpr uint32_t kNumObjs = 100000;
+constexpr uint32_t kMaxNumObjsPerHost = 8192;
+
+struct Obj {
+  uint64_t val;
+
+  Obj() = default;
+  Obj(uint64_t v) : val(v) {}
+
+  template <class Archive>
+  void serialize(Archive &ar) {
+    ar(val);
+  }
+};
+
+void do_work() {
+  bool passed = true;
+
+  MicroProcletPool<Obj> pool(kDefaultProcletHeapSize, kMaxNumObjsPerHost);
+  auto micro_proclets = pool.create_batch(kNumObjs, static_cast<uint64_t>(1));
+  micro_proclets.emplace_back(pool.create(static_cast<uint64_t>(1)));
+  uint64_t one = 1;
+  micro_proclets.emplace_back(pool.create_async(one).get());
+
+  for (uint32_t i = 0; i < micro_proclets.size(); i++) {
+    micro_proclets[i].run(+[](Obj &c, uint64_t delta) { c.val += delta; },
+                          static_cast<uint64_t>(i));
+  }
+  for (uint32_t i = 0; i < micro_proclets.size(); i++) {
+    auto val = micro_proclets[i].run(+[](Obj &c) { return c.val; });
+    passed &= (val == i + 1);
+  }
+  // They should have been packed into a handful of hosts.
+  passed &= (micro_proclets.front().get_host_id() !=
+             micro_proclets.back().get_host_id());
+
+  auto &old = micro_proclets[kNumObjs / 2];
+  auto split = pool.split(old);
+  passed &= (split.get_host_id() != old.get_host_id());
+  passed &= (split.run(+[](Obj &c) { return c.val; }) == kNumObjs / 2 + 1);
+  // The stale handle is forwarded to the new host.
+  old.run(+[](Obj &c) { c.val++; });
+  passed &= (split.run(+[](Obj &c) { return c.val; }) == kNumObjs / 2 + 2);
+
+  for (auto &micro_proclet : micro_proclets) {
+    pool.destroy(micro_proclet);
+  }
+
+  if (passed) {
+    std::cout << "Passed" << std::endl;
+  } else {
+    std::cout << "Failed" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) { do_work(); });
+}
@@ -14,6 +14,8 @@ extern "C" {
 
 using namespace nu;
 
+constexpr static uint32_t kCopyChainLength = 64;
+
 class VecStore {
  public:
   VecStore(const std::vector<int> &a, const std::vector<int> &b)
@@ -61,6 +63,19 @@ void do_work() {
     }
   }
 
+  // Copying each copy exhausts the weight held by the handles.
+  std::vector<Proclet<VecStore>> copies{rem_vec};
+  for (uint32_t i = 0; i < kCopyChainLength; i++) {
+    copies.emplace_back(copies.back());
+  }
+  rem_vec.reset();
+  copies.erase(copies.begin(), copies.end() - 1);
+  auto last = rem_adder.run(
+      +[](Adder &_, Proclet<VecStore> rem_vec) { return rem_vec; },
+      copies.back());
+  copies.clear();
+  passed &= (last.run(&VecStore::get_vec_b) == b);
+
   if (passed) {
     std::cout << "Passed" << std::endl;
   } else {
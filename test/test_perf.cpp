@@ -37,7 +37,9 @@ namespace nu {
 
 class Test {
  public:
-  bool run() {
+  bool run() { return run_closed_loop() && run_open_loop(); }
+
+  bool run_closed_loop() {
     FakeWorkAdapter fake_work_adapter;
     Perf perf(fake_work_adapter);
     perf.run(kNumThreads, kTargetMops,
@@ -53,6 +55,30 @@ class Test {
 
     return true;
   }
+
+  bool run_open_loop() {
+    FakeWorkAdapter fake_work_adapter;
+    Perf perf(fake_work_adapter);
+    PerfPhase phases[] = {
+        PerfPhase::step(kTargetMops, kOneSecond),
+        PerfPhase::ramp(kTargetMops, kTargetMops / 2, 2 * kOneSecond),
+        PerfPhase::step(kTargetMops / 2, 2 * kOneSecond)};
+    perf.run_open_loop(phases, kNumThreads, /* warmup_us */ kOneSecond);
+    auto expected_mops = (kTargetMops + kTargetMops * 0.75 * 2 +
+                          kTargetMops / 2 * 2) /
+                         kNumSeconds;
+    auto real_mops = perf.get_real_mops();
+    if (std::abs(real_mops / expected_mops - 1) > 0.05) {
+      return false;
+    }
+    for (uint32_t i = 0; i < std::size(phases); i++) {
+      if (perf.get_phase_nth_lat(i, 99.9) > 20) {
+        return false;
+      }
+    }
+
+    return true;
+  }
 };
 
 }  // namespace nu
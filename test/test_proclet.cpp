@@ -67,6 +67,19 @@ void do_work() {
       std::move(proclet), a, b);
   passed &= match;
 
+  // Large contiguous args are sent in place rather than serialized.
+  std::vector<int> big_a(1 << 16), big_b(1 << 16);
+  std::iota(big_a.begin(), big_a.end(), 0);
+  std::iota(big_b.begin(), big_b.end(), 1);
+  passed &= tmp_proclet.run(
+      +[](ErasedType &, std::vector<int> a, std::vector<int> small,
+          std::vector<int> b) {
+        return std::equal(a.begin(), a.end(), b.begin(),
+                          [](int x, int y) { return x + 1 == y; }) &&
+               small.size() == 4 && small[3] == 4;
+      },
+      big_a, a, big_b);
+
   if (passed) {
     std::cout << "Passed" << std::endl;
   } else {
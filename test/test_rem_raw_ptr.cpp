@@ -84,6 +84,14 @@ void do_work() {
     passed = false;
   }
 
+  // Cached reads observe the writes made through run().
+  passed &= (rem_raw_ptr_a.read_cached() == a);
+  passed &= (rem_raw_ptr_a.read_cached(kOneSecond) == a);
+  rem_raw_ptr_a.run(+[](std::vector<int> &vec_a) { vec_a.push_back(5); });
+  a.push_back(5);
+  passed &= (rem_raw_ptr_a.read_cached() == a);
+  passed &= (rem_raw_ptr_a.read_cached() == a);
+
   if (passed) {
     std::cout << "Passed" << std::endl;
   } else {
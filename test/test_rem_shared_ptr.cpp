@@ -16,6 +16,8 @@ extern "C" {
 
 using namespace nu;
 
+constexpr static uint32_t kCopyChainLength = 64;
+
 class Obj {};
 
 void do_work() {
@@ -91,6 +93,15 @@ void do_work() {
     passed = false;
   }
 
+  // Copying each copy exhausts the weight held by the pointers.
+  std::vector<RemSharedPtr<std::vector<int>>> copies{rem_shared_ptr_a_copy};
+  for (uint32_t i = 0; i < kCopyChainLength; i++) {
+    copies.emplace_back(copies.back());
+  }
+  rem_shared_ptr_a_copy.reset();
+  copies.erase(copies.begin(), copies.end() - 1);
+  passed &= (*copies.back() == a);
+
   if (passed) {
     std::cout << "Passed" << std::endl;
   } else {
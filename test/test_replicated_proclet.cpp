@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <net/ip.h>
+}
+#include <runtime.h>
+
+#include "nu/replicated_proclet.hpp"
+#include "nu/runtime.hpp"
+
+using namespace nu;
+
+constexpr uint32_t kNumReplicas = 2;
+constexpr uint32_t kNumReads = 1000;
+
+class Obj {
+ public:
+  Obj() = default;
+  Obj(uint64_t val) : val_(val) {}
+  uint64_t get() const { return val_; }
+  void set(uint64_t val) { val_ = val; }
+
+  template <class Archive>
+  void serialize(Archive &ar) {
+    ar(val_);
+  }
+
+ private:
+  uint64_t val_;
+};
+
+bool check_reads(ReplicatedProclet<Obj> &proclet, uint64_t expected) {
+  for (uint32_t i = 0; i < kNumReads; i++) {
+    if (proclet.run(&Obj::get) != expected) {
+      return false;
+    }
+    auto val = proclet.run(+[](const Obj &obj) { return obj.get(); });
+    if (val != expected) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void do_work() {
+  bool passed = true;
+
+  auto proclet =
+      make_replicated_proclet<Obj>(kNumReplicas, std::make_tuple(1ULL));
+  passed &= (proclet.get_num_replicas() == kNumReplicas);
+  passed &= check_reads(proclet, 1);
+
+  // Writes must be visible to the reads served by any replica.
+  proclet.run(&Obj::set, 2ULL);
+  passed &= check_reads(proclet, 2);
+  proclet.run(+[](Obj &obj, uint64_t delta) { obj.set(obj.get() + delta); },
+              3ULL);
+  passed &= check_reads(proclet, 5);
+
+  // Replicas added later start from the latest state.
+  proclet.replicate();
+  passed &= (proclet.get_num_replicas() == kNumReplicas + 1);
+  passed &= check_reads(proclet, 5);
+
+  if (passed) {
+    std::cout << "Passed" << std::endl;
+  } else {
+    std::cout << "Failed" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) { do_work(); });
+}
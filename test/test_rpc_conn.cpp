@@ -0,0 +1,111 @@
+#include <net.h>
+#include <runtime.h>
+#include <thread.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "nu/proclet.hpp"
+#include "nu/runtime.hpp"
+#include "nu/utils/rpc_conn.hpp"
+
+using namespace nu;
+
+constexpr uint32_t kServerIP = MAKE_IP_ADDR(18, 18, 1, 2);
+constexpr uint32_t kClientIP = MAKE_IP_ADDR(18, 18, 1, 3);
+constexpr uint16_t kPort = 8089;
+// Wraps around the shared-memory rings a few times.
+constexpr uint64_t kPayloadSize = 3 * RPCConn::kShmRingSize + 123;
+
+std::vector<uint8_t> make_payload(uint8_t seed) {
+  std::vector<uint8_t> payload(kPayloadSize);
+  for (uint64_t i = 0; i < payload.size(); i++) {
+    payload[i] = static_cast<uint8_t>(i * 31 + seed);
+  }
+  return payload;
+}
+
+class Server {
+ public:
+  // Echoes one length-prefixed payload on each connection.
+  void echo(uint32_t num_conns) {
+    std::unique_ptr<rt::TcpQueue> q(
+        rt::TcpQueue::Listen({.ip = 0, .port = kPort}, num_conns));
+    BUG_ON(!q);
+    for (uint32_t i = 0; i < num_conns; i++) {
+      RPCConn c(std::unique_ptr<rt::TcpConn>(q->Accept()));
+      BUG_ON(!c.Accept());
+      uint64_t len;
+      BUG_ON(c.ReadFull(&len, sizeof(len)) <= 0);
+      std::vector<uint8_t> buf(len);
+      BUG_ON(c.ReadFull(buf.data(), len) <= 0);
+      iovec iovecs[] = {{&len, sizeof(len)}, {buf.data(), len}};
+      BUG_ON(c.WritevFull(iovecs) < 0);
+      BUG_ON(c.Shutdown(SHUT_WR) != 0);
+      // Waits for the client to finish reading.
+      uint8_t eof;
+      BUG_ON(c.ReadFull(&eof, sizeof(eof)) != 0);
+    }
+    q->Shutdown();
+  }
+};
+
+class Client {
+ public:
+  bool run(bool allow_shm) {
+    auto c = RPCConn::Dial(0, {.ip = kServerIP, .port = kPort}, allow_shm);
+    BUG_ON(!c);
+    // The two nodes of the test run on the same host.
+    if (c->is_shm() != allow_shm) {
+      return false;
+    }
+
+    auto payload = make_payload(allow_shm);
+    uint64_t len = payload.size();
+    iovec iovecs[] = {{&len, sizeof(len)}, {payload.data(), len}};
+    BUG_ON(c->WritevFull(iovecs) < 0);
+
+    uint64_t echoed_len;
+    BUG_ON(c->ReadFull(&echoed_len, sizeof(echoed_len)) <= 0);
+    if (echoed_len != len) {
+      return false;
+    }
+    std::vector<uint8_t> echoed(echoed_len);
+    BUG_ON(c->ReadFull(echoed.data(), echoed_len) <= 0);
+    BUG_ON(c->Shutdown(SHUT_WR) != 0);
+    return echoed == payload;
+  }
+};
+
+void do_work() {
+  bool passed = true;
+
+  auto server_proclet = make_proclet<Server>(true, std::nullopt, kServerIP);
+  auto future = server_proclet.run_async(&Server::echo, 2);
+  delay_us(100);
+
+  // Over the shared-memory rings, and then with the TCP fallback.
+  auto client_proclet = make_proclet<Client>(true, std::nullopt, kClientIP);
+  passed &= client_proclet.run(&Client::run, true);
+  passed &= client_proclet.run(&Client::run, false);
+  future.get();
+
+  // A whole RPC whose request and response are both larger than a ring.
+  auto payload = make_payload(42);
+  auto echoed = server_proclet.run(
+      +[](Server &, std::vector<uint8_t> payload) { return payload; },
+      payload);
+  passed &= (echoed == payload);
+
+  if (passed) {
+    std::cout << "Passed" << std::endl;
+  } else {
+    std::cout << "Failed" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) { do_work(); });
+}
@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <net/ip.h>
+}
+#include <runtime.h>
+
+#include "nu/runtime.hpp"
+#include "nu/sharded_set.hpp"
+#include "nu/sharded_sorted_map.hpp"
+#include "nu/sharded_vector.hpp"
+
+using namespace nu;
+
+constexpr uint32_t kMaxShardSize = 64;
+constexpr uint32_t kMaxBatchSize = 16;
+constexpr uint32_t kNumEntries = 4096;
+
+bool test_vector() {
+  auto vec = make_sharded_vector<uint64_t>(kMaxShardSize, kMaxBatchSize);
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    vec.push_back(i * 2);
+  }
+  if (vec.size() != kNumEntries || vec.num_shards() < 2) {
+    return false;
+  }
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    if (vec[i] != i * 2) {
+      return false;
+    }
+  }
+  vec.set(7, 1);
+  return vec[7] == 1 && !vec.find_data(kNumEntries);
+}
+
+bool test_sorted_map() {
+  auto map = make_sharded_sorted_map<uint64_t, uint64_t>(kMaxShardSize,
+                                                         kMaxBatchSize);
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    map.insert(i, i + 1);
+  }
+  auto num_shards = map.num_shards();
+  if (map.size() != kNumEntries || num_shards < 2) {
+    return false;
+  }
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    if (map.find_data(i) != i + 1) {
+      return false;
+    }
+  }
+
+  // Shrinking shards get merged.
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    if (i % 8 && !map.erase(i)) {
+      return false;
+    }
+  }
+  if (map.size() != kNumEntries / 8 || map.num_shards() >= num_shards) {
+    return false;
+  }
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    if (map.find_data(i).has_value() != !(i % 8)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_set() {
+  auto set = make_sharded_set<uint64_t>(kMaxShardSize, kMaxBatchSize);
+  for (uint64_t i = 0; i < kNumEntries; i++) {
+    set.insert(kNumEntries - i);
+  }
+  if (set.size() != kNumEntries) {
+    return false;
+  }
+  for (uint64_t i = 1; i <= kNumEntries; i++) {
+    if (!set.contains(i)) {
+      return false;
+    }
+  }
+  return !set.contains(0) && set.erase(1) && !set.contains(1);
+}
+
+void do_work() {
+  bool passed = true;
+
+  passed &= test_vector();
+  passed &= test_sorted_map();
+  passed &= test_set();
+
+  if (passed) {
+    std::cout << "Passed" << std::endl;
+  } else {
+    std::cout << "Failed" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) { do_work(); });
+}
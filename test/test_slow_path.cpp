@@ -1,5 +1,7 @@
 #include <atomic>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 #include "nu/pressure_handler.hpp"
 #include "nu/proclet.hpp"
@@ -11,15 +13,21 @@
 constexpr uint32_t kMagic = 0x12345678;
 constexpr uint32_t ip0 = MAKE_IP_ADDR(18, 18, 1, 2);
 constexpr uint32_t ip1 = MAKE_IP_ADDR(18, 18, 1, 3);
+constexpr uint64_t kBulkArgLen = 1 << 16;
 
 namespace nu {
 
+class CallerObj;
+
 class CalleeObj {
  public:
   uint32_t foo() {
     Time::delay_us(1000 * 1000);
     return kMagic;
   }
+
+  uint64_t sum_and_call_back(std::vector<uint64_t> vec,
+                             WeakProclet<CallerObj> caller_obj);
 };
 
 class CallerObj {
@@ -29,8 +37,41 @@ class CallerObj {
   uint32_t foo(Proclet<CalleeObj> callee_obj) {
     return callee_obj.run(&CalleeObj::foo);
   }
+
+  uint32_t magic() { return kMagic; }
+
+  uint64_t bulk_foo(Proclet<CalleeObj> callee_obj,
+                    WeakProclet<CallerObj> self) {
+    std::vector<uint64_t> vec(kBulkArgLen);
+    std::iota(vec.begin(), vec.end(), 0);
+    if (!sent_in_place(vec)) {
+      return 0;
+    }
+    return callee_obj.run(&CalleeObj::sum_and_call_back, vec, self);
+  }
+
+ private:
+  // Whether the vector, which lives in this proclet's heap, is handed to the
+  // RPC layer in place rather than copied into the stream.
+  static bool sent_in_place(const std::vector<uint64_t> &vec) {
+    RuntimeSlabGuard g;
+    auto *oa_sstream = get_runtime()->archive_pool()->get_oa_sstream();
+    ProcletServer::serialize_arg(oa_sstream, vec);
+    auto &segs = oa_sstream->bulk_segs;
+    bool in_place = segs.size() == 1 && segs[0].iov_base == vec.data();
+    get_runtime()->archive_pool()->put_oa_sstream(oa_sstream);
+    return in_place;
+  }
 };
 
+uint64_t CalleeObj::sum_and_call_back(std::vector<uint64_t> vec,
+                                      WeakProclet<CallerObj> caller_obj) {
+  Time::delay_us(1000 * 1000);
+  // The caller is being migrated by now.
+  return std::accumulate(vec.begin(), vec.end(), uint64_t{0}) +
+         caller_obj.run(&CallerObj::magic);
+}
+
 class Test {
  public:
   bool run_callee_migrated_test() {
@@ -61,9 +102,22 @@ class Test {
     return future.get() == kMagic;
   }
 
+  // The caller must not stay pinned by its in-place args until the callee
+  // returns, or migrating it would deadlock with the callee calling back.
+  bool run_caller_migrated_with_bulk_args_test() {
+    auto caller_obj = make_proclet<CallerObj>(false, std::nullopt, ip0);
+    auto callee_obj = make_proclet<CalleeObj>(true, std::nullopt, ip1);
+    auto future = caller_obj.run_async(
+        &CallerObj::bulk_foo, std::move(callee_obj), caller_obj.get_weak());
+    delay_us(500 * 1000);
+    caller_obj.run(+[](CallerObj &_) { Test::migrate(); });
+    return future.get() == kBulkArgLen * (kBulkArgLen - 1) / 2 + kMagic;
+  }
+
   bool run_all_tests() {
     return run_callee_migrated_test() && run_caller_migrated_test() &&
-           run_both_migrated_test();
+           run_both_migrated_test() &&
+           run_caller_migrated_with_bulk_args_test();
   }
 
   static void migrate() {
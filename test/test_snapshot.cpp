@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <net/ip.h>
+}
+#include <runtime.h>
+
+#include "nu/proclet.hpp"
+#include "nu/runtime.hpp"
+
+using namespace nu;
+
+constexpr uint32_t kNumElements = 1 << 20;
+const std::string kSnapshotPath = "/tmp/test_snapshot.img";
+
+class Obj {
+ public:
+  Obj() : vec_(kNumElements) { std::iota(vec_.begin(), vec_.end(), 0); }
+  uint64_t sum() { return std::accumulate(vec_.begin(), vec_.end(), 0ULL); }
+  void push(uint32_t x) { vec_.push_back(x); }
+
+ private:
+  std::vector<uint32_t> vec_;
+};
+
+void do_work() {
+  bool passed = true;
+
+  // Snapshots are written to the hosting node's local file system.
+  auto proclet = make_proclet<Obj>(false, std::nullopt, get_cfg_ip());
+  auto expected_sum = proclet.run(&Obj::sum);
+  auto id = proclet.get_id();
+  passed &= proclet.snapshot(kSnapshotPath);
+  proclet.reset();
+
+  auto restored = restore_proclet<Obj>(kSnapshotPath);
+  passed &= (restored && restored.get_id() == id);
+  if (passed) {
+    passed &= (restored.run(&Obj::sum) == expected_sum);
+    // The restored heap must be writable and keep working as usual.
+    restored.run(&Obj::push, kNumElements);
+    passed &= (restored.run(&Obj::sum) == expected_sum + kNumElements);
+    // Its address range is now taken.
+    passed &= !restore_proclet<Obj>(kSnapshotPath);
+  }
+  std::remove(kSnapshotPath.c_str());
+
+  if (passed) {
+    std::cout << "Passed" << std::endl;
+  } else {
+    std::cout << "Failed" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  return runtime_main_init(argc, argv, [](int, char **) { do_work(); });
+}